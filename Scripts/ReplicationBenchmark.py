@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""Compares server replication time between CMCTestReplicationGraph, the engine's default replication driver and Iris.
+
+Runs a soak (see Soak.py) for each connection count with each, then prints one row per run:
+
+  Scripts/ReplicationBenchmark.py --build Build/Linux --clients 32 64 100
+"""
+
+import argparse
+import sys
+
+import Soak
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--build", required=True, help="Staged Linux build containing LinuxServer and Linux")
+    parser.add_argument("--clients", type=int, nargs="+", default=[32, 64, 100])
+    parser.add_argument("--duration", type=int, default=120, help="Seconds to capture once all clients are in")
+    args = parser.parse_args()
+
+    results = []
+    for clients in args.clients:
+        for driver, server_args, client_args in (
+            ("graph", [], []),
+            ("default", [Soak.DEFAULT_REPLICATION], []),
+            ("iris", [Soak.IRIS], [Soak.IRIS]),
+        ):
+            path = Soak.run(args.build, clients, args.duration, server_args=server_args, client_args=client_args)
+            results.append((clients, driver, Soak.report(path, clients) if path else None))
+
+    print()
+    print(f"{'clients':>8} {'driver':>8} {'rep mean':>9} {'rep p99':>8} {'frame p50':>10} {'frame p99':>10}")
+    for clients, driver, result in results:
+        if not result:
+            print(f"{clients:>8} {driver:>8} {'no data':>9}")
+            continue
+
+        # Iris doesn't go through ServerReplicateActors, so only its frame times compare.
+        if result["replication_mean"] is None:
+            replication = f"{'-':>9} {'-':>8}"
+        else:
+            replication = f"{result['replication_mean']:>9.2f} {result['replication_p99']:>8.2f}"
+
+        print(f"{clients:>8} {driver:>8} {replication} {result['frame_p50']:>10.2f} {result['frame_p99']:>10.2f}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
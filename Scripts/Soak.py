@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Headless soak run: a Linux dedicated server plus N -nullrhi bot clients on localhost.
+
+The server captures a CSV for the run, which this script then reduces to server frame time percentiles, bytes per
+client per second and the correction rate. Build CMCTestServer and CMCTest for Linux first, e.g.
+
+  RunUAT.sh BuildCookRun -project=CMCTest.uproject -platform=Linux -server -serverplatform=Linux \\
+      -build -cook -stage -pak -archive -archivedirectory=Build
+
+then run
+
+  Scripts/Soak.py --build Build/Linux --clients 16 --duration 300
+"""
+
+import argparse
+import csv
+import glob
+import os
+import statistics
+import subprocess
+import sys
+import time
+
+MAP = "/Game/FirstPerson/Maps/FirstPersonMap"
+
+# Falls back to the engine's default replication instead of CMCTestReplicationGraph.
+DEFAULT_REPLICATION = "-dpcvars=CMCTest.ReplicationGraph.Enabled=0"
+
+# Replicates through Iris instead, which ignores the replication driver. Server and clients must both pass it.
+IRIS = "-UseIris"
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, max(0, round(p / 100 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def read_csv(path):
+    with open(path, newline="") as file:
+        rows = list(csv.reader(file))
+
+    header = rows[0]
+    frames = []
+
+    # Captures end with a metadata row and, when the header is written last, a copy of the header.
+    for row in rows[1:]:
+        if not row or row[0].startswith("[") or row == header:
+            break
+
+        frame = {}
+        for name, value in zip(header, row):
+            try:
+                frame[name] = float(value)
+            except ValueError:
+                pass
+
+        frames.append(frame)
+
+    return frames
+
+
+def report(path, clients):
+    """Prints the run's numbers and returns them, or None when no frame had every client connected."""
+
+    # Only frames with every bot connected count, so joining and leaving don't skew the numbers.
+    frames = [frame for frame in read_csv(path) if frame.get("CMCTest/Clients", 0) >= clients]
+    if not frames:
+        print(f"No frames in {path} had all {clients} clients connected", file=sys.stderr)
+        return None
+
+    def column(name):
+        return [frame[name] for frame in frames if name in frame]
+
+    frame_times = column("FrameTime")
+    seconds = sum(frame_times) / 1000
+    out_bytes = column("CMCTest/OutBytesPerClientPerSecond")
+    in_bytes = column("CMCTest/InBytesPerClientPerSecond")
+    corrections = sum(column("CMCTest/CorrectionsSent"))
+    moves = sum(column("CMCTest/ServerMoves"))
+    replication = next((column(name) for name in frames[0] if name.endswith("NetServerRepActorsTime")), [])
+
+    print(f"CSV: {path}")
+    print(f"Frames: {len(frame_times)} over {seconds:.1f}s with {clients} clients")
+    print("Server frame time (ms): p50 {:.2f}  p90 {:.2f}  p99 {:.2f}  max {:.2f}".format(
+        percentile(frame_times, 50), percentile(frame_times, 90), percentile(frame_times, 99), max(frame_times)))
+
+    if out_bytes:
+        print(f"Bytes per client per second: out {statistics.mean(out_bytes):.0f}  in {statistics.mean(in_bytes):.0f}")
+
+    if moves:
+        print(f"Corrections: {corrections:.0f} of {moves:.0f} moves ({100 * corrections / moves:.2f}%), "
+              f"{corrections / max(seconds * clients, 1):.3f} per client per second")
+
+    if replication:
+        print("Server replication (ms): mean {:.2f}  p99 {:.2f}".format(
+            statistics.mean(replication), percentile(replication, 99)))
+
+    return {
+        "frame_p50": percentile(frame_times, 50),
+        "frame_p99": percentile(frame_times, 99),
+        "replication_mean": statistics.mean(replication) if replication else None,
+        "replication_p99": percentile(replication, 99) if replication else None,
+        "out_bytes": statistics.mean(out_bytes) if out_bytes else None,
+        "corrections": corrections / moves if moves else None,
+    }
+
+
+def run(build, clients, duration, port=7777, tick_rate=30, join_delay=0.5, server_args=(), client_args=()):
+    """Runs one soak and returns the path of the server's CSV, or None if it didn't write one."""
+
+    server_binary = os.path.join(build, "LinuxServer", "CMCTest", "Binaries", "Linux", "CMCTestServer")
+    client_binary = os.path.join(build, "Linux", "CMCTest", "Binaries", "Linux", "CMCTest")
+    csv_dir = os.path.join(build, "LinuxServer", "CMCTest", "Saved", "Profiling", "CSV")
+
+    settle = clients * join_delay + 10
+    frames = int((settle + duration) * tick_rate)
+    started = time.time()
+
+    server = subprocess.Popen([
+        server_binary, MAP, "-log", "-unattended", f"-port={port}", f"-csvCaptureFrames={frames}", *server_args,
+    ])
+
+    time.sleep(5)
+
+    bots = []
+    for index in range(clients):
+        bots.append(subprocess.Popen([
+            client_binary, f"127.0.0.1:{port}", "-nullrhi", "-nosound", "-unattended", "-CMCTestBot",
+            f"-log=Bot{index}.log", *client_args,
+        ], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL))
+        time.sleep(join_delay)
+
+    try:
+        time.sleep(settle + duration)
+    finally:
+        for process in bots + [server]:
+            process.terminate()
+
+        for process in bots + [server]:
+            process.wait()
+
+    captures = [path for path in glob.glob(os.path.join(csv_dir, "*.csv")) if os.path.getmtime(path) >= started]
+    if not captures:
+        print(f"No CSV written to {csv_dir}", file=sys.stderr)
+        return None
+
+    return max(captures, key=os.path.getmtime)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--build", required=True, help="Staged Linux build containing LinuxServer and Linux")
+    parser.add_argument("--clients", type=int, default=8)
+    parser.add_argument("--duration", type=int, default=120, help="Seconds to capture once all clients are in")
+    parser.add_argument("--port", type=int, default=7777)
+    parser.add_argument("--tick-rate", type=int, default=30, help="Server tick rate, used to size the capture")
+    parser.add_argument("--join-delay", type=float, default=0.5, help="Seconds between client launches")
+    replication = parser.add_mutually_exclusive_group()
+    replication.add_argument("--default-replication", action="store_true",
+                             help="Use the engine's default replication driver instead of the replication graph")
+    replication.add_argument("--iris", action="store_true", help="Replicate through Iris on the server and clients")
+    args = parser.parse_args()
+
+    server_args = [DEFAULT_REPLICATION] if args.default_replication else [IRIS] if args.iris else []
+    client_args = [IRIS] if args.iris else []
+
+    path = run(args.build, args.clients, args.duration, args.port, args.tick_rate, args.join_delay,
+               server_args, client_args)
+    if not path:
+        return 1
+
+    return 0 if report(path, args.clients) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,130 @@
+#include "AssetPreloadSubsystem.h"
+#include "CMCTest.h"
+#include "CMCTestGameMode.h"
+#include "Engine/AssetManager.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameStateBase.h"
+#include "TP_WeaponComponent.h"
+
+void UAssetPreloadSubsystem::StartPreload()
+{
+  if (Started)
+  {
+    return;
+  }
+
+  Started = true;
+  StartTime = FPlatformTime::Seconds();
+
+  TArray<FSoftObjectPath> paths;
+  GatherStartupAssets(paths);
+  NumStartupAssets = paths.Num();
+
+  if (paths.Num() > 0)
+  {
+    StartupHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+        MoveTemp(paths),
+        FStreamableDelegate::CreateUObject(this, &UAssetPreloadSubsystem::OnStartupAssetsLoaded),
+        FStreamableManager::AsyncLoadHighPriority);
+  }
+
+  // Already loaded assets complete without calling back.
+  if (!StartupHandle || StartupHandle->HasLoadCompleted())
+  {
+    OnStartupAssetsLoaded();
+  }
+}
+
+bool UAssetPreloadSubsystem::IsReady() const
+{
+  return Ready;
+}
+
+void UAssetPreloadSubsystem::CallWhenReady(FSimpleDelegate callback)
+{
+  if (Ready)
+  {
+    callback.ExecuteIfBound();
+    return;
+  }
+
+  ReadyCallbacks.Add(MoveTemp(callback));
+}
+
+void UAssetPreloadSubsystem::Preload(TArray<FSoftObjectPath> paths)
+{
+  paths.RemoveAll([](const FSoftObjectPath &path) { return path.IsNull() || path.ResolveObject() != nullptr; });
+
+  if (paths.Num() > 0)
+  {
+    Handles.Add(UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(paths)));
+  }
+}
+
+bool UAssetPreloadSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+  return worldType == EWorldType::Game || worldType == EWorldType::PIE;
+}
+
+void UAssetPreloadSubsystem::OnWorldBeginPlay(UWorld &world)
+{
+  Super::OnWorldBeginPlay(world);
+
+  // The server started already, from the game mode.
+  StartPreload();
+}
+
+void UAssetPreloadSubsystem::GatherStartupAssets(TArray<FSoftObjectPath> &paths) const
+{
+  // Clients don't have the game mode, but the game state tells them its class.
+  auto world = GetWorld();
+  auto gameState = world->GetGameState();
+  auto gameModeClass = world->GetAuthGameMode() ? world->GetAuthGameMode()->GetClass()
+                       : gameState              ? gameState->GameModeClass.Get()
+                                                : nullptr;
+
+  if (auto gameMode = gameModeClass ? Cast<ACMCTestGameMode>(gameModeClass->GetDefaultObject()) : nullptr)
+  {
+    gameMode->GetAssetsToPreload(paths);
+  }
+
+  for (TActorIterator<AActor> it(world); it; ++it)
+  {
+    TInlineComponentArray<UTP_WeaponComponent *> weapons(*it);
+
+    for (auto weapon : weapons)
+    {
+      weapon->GetAssetsToPreload(paths);
+    }
+  }
+
+  paths.RemoveAll([](const FSoftObjectPath &path) { return path.IsNull(); });
+}
+
+void UAssetPreloadSubsystem::OnStartupAssetsLoaded()
+{
+  if (Ready)
+  {
+    return;
+  }
+
+  Ready = true;
+
+  auto world = GetWorld();
+  UE_LOG(
+      LogCMCTest,
+      Display,
+      TEXT("Preloaded %d assets for %s in %.3fs, ready %.3fs after startup"),
+      NumStartupAssets,
+      world->GetNetMode() == NM_Client ? TEXT("client") : TEXT("server"),
+      FPlatformTime::Seconds() - StartTime,
+      FPlatformTime::Seconds() - GStartTime);
+  CSV_EVENT(CMCTest, TEXT("AssetsPreloaded"));
+
+  auto callbacks = MoveTemp(ReadyCallbacks);
+  for (auto &callback : callbacks)
+  {
+    callback.ExecuteIfBound();
+  }
+}
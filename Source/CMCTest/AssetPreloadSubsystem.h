@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AssetPreloadSubsystem.generated.h"
+
+struct FStreamableHandle;
+
+// Streams in the soft referenced assets players need (the game mode's pawn class and the weapons' projectile, sound
+// and animation) in the background while the map starts up, instead of loading them the first time they're used.
+// The server starts it from the game mode, so players can be held back until it's done; clients start it when their
+// world begins play. Logs how long the load took once it's done.
+UCLASS()
+class UAssetPreloadSubsystem : public UWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  // Gathers and starts loading the startup assets. Only the first call does anything.
+  void StartPreload();
+  bool IsReady() const;
+  // Calls back once the startup assets are loaded, right away if they already are.
+  void CallWhenReady(FSimpleDelegate callback);
+
+  // Loads more assets in the background and keeps them loaded for the rest of the world's life.
+  void Preload(TArray<FSoftObjectPath> paths);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+  virtual void OnWorldBeginPlay(UWorld &world) override;
+
+  void GatherStartupAssets(TArray<FSoftObjectPath> &paths) const;
+  void OnStartupAssetsLoaded();
+
+  TSharedPtr<FStreamableHandle> StartupHandle;
+  TArray<TSharedPtr<FStreamableHandle>> Handles;
+  TArray<FSimpleDelegate> ReadyCallbacks;
+  bool Started = false;
+  bool Ready = false;
+  int32 NumStartupAssets = 0;
+  double StartTime = 0;
+};
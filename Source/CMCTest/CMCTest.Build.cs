@@ -8,6 +8,9 @@ public class CMCTest : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "NetCore", "ReplicationGraph", "SignificanceManager" });
+
+		// Iris is compiled in and chosen at runtime, see net.Iris.UseIrisReplication in DefaultEngine.ini
+		SetupIrisSupport(Target);
 	}
 }
@@ -1,7 +1,32 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CMCTest.h"
+#include "CMCTestReplicationGraph.h"
+#include "CMCTestTrace.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CMCTest, "CMCTest" );
+DEFINE_LOG_CATEGORY(LogCMCTest);
+
+CSV_DEFINE_CATEGORY(CMCTest, true);
+
+#if CMCTEST_TRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(CMCTestChannel);
+#endif
+
+class FCMCTestModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		// Decides per net driver whether to use the replication graph, see CMCTest.ReplicationGraph.Enabled
+		UReplicationDriver::CreateReplicationDriverDelegate().BindStatic(&UCMCTestReplicationGraph::CreateReplicationDriver);
+	}
+
+	virtual void ShutdownModule() override
+	{
+		UReplicationDriver::CreateReplicationDriverDelegate().Unbind();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FCMCTestModule, CMCTest, "CMCTest" );
  
\ No newline at end of file
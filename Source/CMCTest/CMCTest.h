@@ -3,3 +3,10 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCMCTest, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("CMCTest"), STATGROUP_CMCTest, STATCAT_Advanced);
+
+CSV_DECLARE_CATEGORY_EXTERN(CMCTest);
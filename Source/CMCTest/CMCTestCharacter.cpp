@@ -11,9 +11,24 @@
 #include "InputActionValue.h"
 #include "CMCTestCharacterMovementComponent.h"
 #include "Engine/LocalPlayer.h"
+#include "EngineUtils.h"
+#include "CMCTestReplicationGraph.h"
+#include "OscillatingActor.h"
+#include "SignificanceManager.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
+namespace
+{
+	/** Server replication rate for each LOD, far to near */
+	constexpr float NetUpdateFrequencies[] = { 10.f, 30.f, 100.f };
+
+	/** Simulated proxy movement and mesh tick intervals for each LOD, far to near */
+	constexpr float ProxyTickIntervals[] = { 1.f / 15.f, 1.f / 30.f, 0.f };
+
+	const FName CharacterSignificanceTag(TEXT("CMCTestCharacter"));
+}
+
 //////////////////////////////////////////////////////////////////////////
 // ACMCTestCharacter
 
@@ -45,6 +60,138 @@ void ACMCTestCharacter::BeginPlay()
 	Super::BeginPlay();
 
 	MovementComponent = Cast<UCMCTestCharacterMovementComponent>(GetCharacterMovement());
+
+	bIsBot = IsLocallyControlled() && FParse::Param(FCommandLine::Get(), TEXT("CMCTestBot"));
+	BotRandom.Initialize(FPlatformProcess::GetCurrentProcessId());
+
+	// Other players' characters are ranked against the local viewpoint and cheapened with distance
+	USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld());
+	if (SignificanceManager != nullptr && GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		SignificanceManager->RegisterObject(
+			this,
+			CharacterSignificanceTag,
+			[](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+			{
+				const ACMCTestCharacter* Character = CastChecked<ACMCTestCharacter>(ObjectInfo->GetObject());
+				return static_cast<float>(Character->GetLODForDistance(FVector::Dist(Viewpoint.GetLocation(), Character->GetActorLocation())));
+			},
+			USignificanceManager::EPostSignificanceType::Sequential,
+			[](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+			{
+				CastChecked<ACMCTestCharacter>(ObjectInfo->GetObject())->ApplyProxyLOD(static_cast<int32>(Significance));
+			});
+	}
+}
+
+void ACMCTestCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld()))
+	{
+		SignificanceManager->UnregisterObject(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACMCTestCharacter::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bIsBot)
+	{
+		TickBot(DeltaSeconds);
+	}
+}
+
+int32 ACMCTestCharacter::GetLODForDistance(float Distance) const
+{
+	return Distance < NearLODDistance ? 2 : Distance < FarLODDistance ? 1 : 0;
+}
+
+void ACMCTestCharacter::ApplyProxyLOD(int32 LOD)
+{
+	if (LOD == ProxyLOD)
+	{
+		return;
+	}
+
+	ProxyLOD = LOD;
+	const bool bNear = LOD == 2;
+
+	// Linear smoothing skips the exponential mesh offset decay, which is plenty for something far away
+	GetCharacterMovement()->NetworkSmoothingMode = bNear ? ENetworkSmoothingMode::Exponential : ENetworkSmoothingMode::Linear;
+	GetCharacterMovement()->SetComponentTickInterval(ProxyTickIntervals[LOD]);
+
+	// Let URO throttle animation with distance, and stop animating far meshes nobody can see
+	USkeletalMeshComponent* ThirdPersonMesh = GetMesh();
+	ThirdPersonMesh->bEnableUpdateRateOptimizations = !bNear;
+	ThirdPersonMesh->VisibilityBasedAnimTickOption = LOD == 0 ? EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered : EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	ThirdPersonMesh->SetComponentTickInterval(ProxyTickIntervals[LOD]);
+}
+
+void ACMCTestCharacter::SetNetUpdateLOD(int32 LOD)
+{
+	const float Frequency = NetUpdateFrequencies[LOD];
+	if (Frequency == NetUpdateFrequency)
+	{
+		return;
+	}
+
+	// Catch up straight away when someone comes close
+	if (Frequency > NetUpdateFrequency)
+	{
+		ForceNetUpdate();
+	}
+
+	NetUpdateFrequency = Frequency;
+
+	if (UCMCTestReplicationGraph* ReplicationGraph = UCMCTestReplicationGraph::Get(GetWorld()))
+	{
+		ReplicationGraph->SetActorUpdateFrequency(this, Frequency);
+	}
+}
+
+void ACMCTestCharacter::TickBot(float DeltaSeconds)
+{
+	BotTime += DeltaSeconds;
+
+	// Wander with a slowly changing heading so bots spread out over the map
+	FVector2D MovementVector(FMath::Sin(BotTime * 0.7f), FMath::Cos(BotTime * 0.3f));
+	AddMovementInput(GetActorForwardVector(), MovementVector.Y);
+	AddMovementInput(GetActorRightVector(), MovementVector.X);
+	AddControllerYawInput(BotRandom.FRandRange(-1.f, 1.f));
+
+	// Hold jump briefly so the movement component sees it
+	if (FMath::Fmod(BotTime + BotRandom.GetInitialSeed(), 3.f) < 0.2f)
+	{
+		Jump();
+	}
+	else
+	{
+		StopJumping();
+	}
+
+	// Every few seconds, aim at the nearest oscillating block and pull toward it for a second
+	const float PullCycle = FMath::Fmod(BotTime, 5.f);
+	if (PullCycle < DeltaSeconds && Controller != nullptr)
+	{
+		AOscillatingActor* Nearest = nullptr;
+		for (TActorIterator<AOscillatingActor> It(GetWorld()); It; ++It)
+		{
+			if (Nearest == nullptr || GetSquaredDistanceTo(*It) < GetSquaredDistanceTo(Nearest))
+			{
+				Nearest = *It;
+			}
+		}
+
+		if (Nearest != nullptr)
+		{
+			Controller->SetControlRotation((Nearest->GetActorLocation() - GetActorLocation()).Rotation());
+		}
+	}
+
+	MovementComponent->WantsToPullLocally = PullCycle < 1.f;
 }
 
 //////////////////////////////////////////////////////////////////////////// Input
@@ -99,6 +246,14 @@ void ACMCTestCharacter::Look(const FInputActionValue &Value)
 	}
 }
 
+void ACMCTestCharacter::ServerFireShots_Implementation(const TArray<FWeaponShot> &Shots)
+{
+	if (UTP_WeaponComponent *Weapon = GetInstanceComponents().FindItemByClass<UTP_WeaponComponent>())
+	{
+		Weapon->HandleServerShots(Shots);
+	}
+}
+
 void ACMCTestCharacter::StartPull(const FInputActionValue &Value)
 {
 	MovementComponent->WantsToPullLocally = true;
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Logging/LogMacros.h"
+#include "TP_WeaponComponent.h"
 #include "CMCTestCharacter.generated.h"
 
 class UInputComponent;
@@ -44,11 +45,39 @@ class ACMCTestCharacter : public ACharacter
 public:
 	ACMCTestCharacter(const FObjectInitializer &ObjectInitializer);
 
+	/** Remote characters closer than this keep full smoothing, animation and update rate */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = LOD)
+	float NearLODDistance = 2000.f;
+
+	/** Remote characters further than this get the cheapest smoothing, animation and update rate */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = LOD)
+	float FarLODDistance = 5000.f;
+
+	/** 2 when near, 1 in between and 0 when far */
+	int32 GetLODForDistance(float Distance) const;
+
+	/** Sets how often the server replicates this character from the LOD of the nearest other player, see the game mode */
+	void SetNetUpdateLOD(int32 LOD);
+
 protected:
 	virtual void BeginPlay();
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
 
 	UCMCTestCharacterMovementComponent *MovementComponent;
 
+	/** Drives this character with scripted input instead of a player, set with -CMCTestBot for soak runs */
+	bool bIsBot = false;
+	float BotTime = 0.f;
+	FRandomStream BotRandom;
+
+	void TickBot(float DeltaSeconds);
+
+	/** Cheapens smoothing, movement and animation on a simulated proxy the viewer is far from */
+	void ApplyProxyLOD(int32 LOD);
+
+	int32 ProxyLOD = INDEX_NONE;
+
 public:
 	/** Look Input Action */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
@@ -70,6 +99,10 @@ protected:
 	// End of APawn interface
 
 public:
+	/** Sends the shots this client fired since the last net update to its weapon on the server */
+	UFUNCTION(Server, Unreliable)
+	void ServerFireShots(const TArray<FWeaponShot> &Shots);
+
 	/** Returns Mesh1P subobject **/
 	USkeletalMeshComponent *GetMesh1P() const { return Mesh1P; }
 	/** Returns FirstPersonCameraComponent subobject **/
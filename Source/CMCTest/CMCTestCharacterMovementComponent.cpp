@@ -1,5 +1,24 @@
 #include "CMCTestCharacterMovementComponent.h"
+#include "CMCTest.h"
+#include "CMCTestTrace.h"
 #include "GameFramework/Character.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "MoveRecordingSubsystem.h"
+#include "PullTarget.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "PullTargetSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("OnMovementUpdated"), STAT_CMCTest_OnMovementUpdated, STATGROUP_CMCTest);
+DECLARE_CYCLE_STAT(TEXT("MoveAutonomous"), STAT_CMCTest_MoveAutonomous, STATGROUP_CMCTest);
+DECLARE_CYCLE_STAT(TEXT("Pull Trace"), STAT_CMCTest_PullTrace, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pulls Started"), STAT_CMCTest_PullsStarted, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Corrections Received"), STAT_CMCTest_CorrectionsReceived, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Corrections Sent"), STAT_CMCTest_CorrectionsSent, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Server Moves"), STAT_CMCTest_ServerMoves, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Saved Moves"), STAT_CMCTest_SavedMoves, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combined Moves"), STAT_CMCTest_CombinedMoves, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Move Bytes Written"), STAT_CMCTest_MoveBytesWritten, STATGROUP_CMCTest);
 
 void FNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character &clientMove, ENetworkMoveType moveType)
 {
@@ -7,7 +26,9 @@ void FNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character &cli
 
   auto savedMove = static_cast<const FCharacterSavedMove &>(clientMove);
 
-  WantsToPull = savedMove.WantsToPull;
+  PullTargetActor = savedMove.StartPull ? savedMove.PullTargetActor.Get() : nullptr;
+  PullTargetOffset = savedMove.PullTargetOffset;
+  PullTargetTimeOffset = savedMove.PullTargetTimeOffset;
 }
 
 bool FNetworkMoveData::Serialize(
@@ -18,27 +39,125 @@ bool FNetworkMoveData::Serialize(
 {
   Super::Serialize(characterMovement, archive, packageMap, moveType);
 
-  SerializeOptionalValue<bool>(archive.IsSaving(), archive, WantsToPull, false);
+  if (CompressedMoveFlags & FSavedMove_Character::FLAG_Custom_1)
+  {
+    if (!packageMap)
+    {
+      archive.SetError();
+      return false;
+    }
+
+    UObject *target = PullTargetActor;
+    packageMap->SerializeObject(archive, AActor::StaticClass(), target);
+    PullTargetActor = Cast<AActor>(target);
+
+    // 0.1uu precision is well under what a correction would notice.
+    SerializePackedVector<10, 24>(PullTargetOffset, archive);
+    archive << PullTargetTimeOffset;
+  }
 
   return !archive.IsError();
 }
 
+uint8 FCharacterSavedMove::GetCompressedFlags() const
+{
+  auto result = Super::GetCompressedFlags();
+
+  if (WantsToPull)
+  {
+    result |= FLAG_Custom_0;
+  }
+
+  if (StartPull)
+  {
+    result |= FLAG_Custom_1;
+  }
+
+  return result;
+}
+
 bool FCharacterSavedMove::CanCombineWith(const FSavedMovePtr &newMove, ACharacter *inCharacter, float maxDelta) const
 {
   auto newCharacterMove = static_cast<FCharacterSavedMove *>(newMove.Get());
 
   if (WantsToPull != newCharacterMove->WantsToPull)
   {
+    CMCTEST_TRACE_EVENT(MoveCombineRejected);
+    return false;
+  }
+
+  if (StartPull || newCharacterMove->StartPull)
+  {
+    CMCTEST_TRACE_EVENT(MoveCombineRejected);
+    return false;
+  }
+
+  // Sustained pulls combine like walking as long as both moves pull toward the same point.
+  if (StartIsPulling != newCharacterMove->StartIsPulling)
+  {
+    CMCTEST_TRACE_EVENT(MoveCombineRejected);
+    return false;
+  }
+
+  if (StartIsPulling &&
+      (StartHitActor != newCharacterMove->StartHitActor || StartOffsetOnActor != newCharacterMove->StartOffsetOnActor ||
+       StartPullTimeOffset != newCharacterMove->StartPullTimeOffset))
+  {
+    CMCTEST_TRACE_EVENT(MoveCombineRejected);
+    return false;
+  }
+
+  if (!Super::CanCombineWith(newMove, inCharacter, maxDelta))
+  {
+    CMCTEST_TRACE_EVENT(MoveCombineRejected);
     return false;
   }
 
-  return Super::CanCombineWith(newMove, inCharacter, maxDelta);
+  return true;
 }
 
 void FCharacterSavedMove::Clear()
 {
   Super::Clear();
   WantsToPull = false;
+  StartPull = false;
+  PullTargetActor = nullptr;
+  PullTargetOffset = FVector::ZeroVector;
+  PullTargetTimeOffset = 0.f;
+  StartIsPulling = false;
+  StartPullSpeed = 0.f;
+  StartHitActor = nullptr;
+  StartOffsetOnActor = FVector::ZeroVector;
+  StartPullTimeOffset = 0.f;
+}
+
+void FCharacterSavedMove::CombineWith(
+    const FSavedMove_Character *oldMove,
+    ACharacter *inCharacter,
+    APlayerController *playerController,
+    const FVector &oldStartLocation)
+{
+  Super::CombineWith(oldMove, inCharacter, playerController, oldStartLocation);
+
+  CMCTEST_TRACE_EVENT(MoveCombined);
+
+  INC_DWORD_STAT(STAT_CMCTest_CombinedMoves);
+  CSV_CUSTOM_STAT(CMCTest, CombinedMoves, 1, ECsvCustomStatOp::Accumulate);
+
+  // The combined move is simulated again from the start of the old one, so the pull has to be rewound with it.
+  auto oldCharacterMove = static_cast<const FCharacterSavedMove *>(oldMove);
+  StartIsPulling = oldCharacterMove->StartIsPulling;
+  StartPullSpeed = oldCharacterMove->StartPullSpeed;
+  StartHitActor = oldCharacterMove->StartHitActor;
+  StartOffsetOnActor = oldCharacterMove->StartOffsetOnActor;
+  StartPullTimeOffset = oldCharacterMove->StartPullTimeOffset;
+
+  auto characterMovement = Cast<UCMCTestCharacterMovementComponent>(inCharacter->GetCharacterMovement());
+  characterMovement->IsPulling = StartIsPulling;
+  characterMovement->PullSpeed = StartPullSpeed;
+  characterMovement->HitActor = StartHitActor;
+  characterMovement->OffsetOnActor = StartOffsetOnActor;
+  characterMovement->PullTimeOffset = StartPullTimeOffset;
 }
 
 void FCharacterSavedMove::SetMoveFor(
@@ -49,8 +168,28 @@ void FCharacterSavedMove::SetMoveFor(
 {
   Super::SetMoveFor(character, inDeltaTime, newAccel, clientData);
 
+  INC_DWORD_STAT(STAT_CMCTest_SavedMoves);
+  CSV_CUSTOM_STAT(CMCTest, SavedMoves, 1, ECsvCustomStatOp::Accumulate);
+
   auto characterMovement = Cast<UCMCTestCharacterMovementComponent>(character->GetCharacterMovement());
+  // First, so the offsets saved with this move already match its timestamp if the client just reset it.
+  characterMovement->SetCurrentMoveTimeStamp(TimeStamp);
   WantsToPull = characterMovement->WantsToPull;
+  StartPull = characterMovement->StartPull;
+  StartIsPulling = characterMovement->IsPulling;
+  StartPullSpeed = characterMovement->PullSpeed;
+  StartHitActor = characterMovement->HitActor;
+  StartOffsetOnActor = characterMovement->OffsetOnActor;
+  StartPullTimeOffset = characterMovement->PullTimeOffset;
+
+  if (StartPull)
+  {
+    // The client's estimate of the server clock is what the server will aim at for the rest of the pull.
+    characterMovement->PullTargetTimeOffset = characterMovement->GetServerTime() - TimeStamp;
+    PullTargetActor = characterMovement->PullTargetActor;
+    PullTargetOffset = characterMovement->PullTargetOffset;
+    PullTargetTimeOffset = characterMovement->PullTargetTimeOffset;
+  }
 }
 
 void FCharacterSavedMove::PrepMoveFor(ACharacter *character)
@@ -58,7 +197,21 @@ void FCharacterSavedMove::PrepMoveFor(ACharacter *character)
   Super::PrepMoveFor(character);
 
   auto characterMovement = Cast<UCMCTestCharacterMovementComponent>(character->GetCharacterMovement());
-  characterMovement->WantsToPull = WantsToPull;
+  characterMovement->IsPulling = StartIsPulling;
+  characterMovement->PullSpeed = StartPullSpeed;
+  characterMovement->HitActor = StartHitActor;
+  characterMovement->OffsetOnActor = StartOffsetOnActor;
+  characterMovement->PullTimeOffset = StartPullTimeOffset;
+  // The offsets restored above were saved against this move's timestamp, so they need no adjusting for a reset.
+  characterMovement->CurrentMoveTimeStamp = TimeStamp;
+
+  if (StartPull)
+  {
+    characterMovement->PullTargetActor = PullTargetActor;
+    characterMovement->PullTargetOffset = PullTargetOffset;
+    characterMovement->PullTargetTimeOffset = PullTargetTimeOffset;
+    characterMovement->HasPullTarget = PullTargetActor.IsValid();
+  }
 }
 
 FNetworkMoveDataContainer::FNetworkMoveDataContainer()
@@ -85,11 +238,28 @@ UCMCTestCharacterMovementComponent::UCMCTestCharacterMovementComponent(const FOb
 {
   SetIsReplicatedByDefault(true);
   SetNetworkMoveDataContainer(MoveDataContainer);
+  PullTraceDelegate.BindUObject(this, &UCMCTestCharacterMovementComponent::OnPullTraceCompleted);
 }
 
 void UCMCTestCharacterMovementComponent::BeginPlay()
 {
   Super::BeginPlay();
+
+  auto pullTargets = GetWorld()->GetSubsystem<UPullTargetSubsystem>();
+  if (pullTargets && GetNetMode() != NM_Client)
+  {
+    pullTargets->RegisterPuller(this);
+  }
+}
+
+void UCMCTestCharacterMovementComponent::EndPlay(const EEndPlayReason::Type endPlayReason)
+{
+  if (auto pullTargets = GetWorld()->GetSubsystem<UPullTargetSubsystem>())
+  {
+    pullTargets->UnregisterPuller(this);
+  }
+
+  Super::EndPlay(endPlayReason);
 }
 
 FNetworkPredictionData_Client *UCMCTestCharacterMovementComponent::GetPredictionData_Client() const
@@ -105,60 +275,524 @@ FNetworkPredictionData_Client *UCMCTestCharacterMovementComponent::GetPrediction
 
 void UCMCTestCharacterMovementComponent::MoveAutonomous(float clientTimeStamp, float deltaTime, uint8 compressedFlags, const FVector &newAccel)
 {
-  if (auto moveData = static_cast<FNetworkMoveData *>(GetCurrentNetworkMoveData()))
+  SCOPE_CYCLE_COUNTER(STAT_CMCTest_MoveAutonomous);
+  CSV_SCOPED_TIMING_STAT(CMCTest, MoveAutonomous);
+
+  // Only moves the server runs on behalf of a remote client count, not ones simulated locally.
+  if (CharacterOwner->HasAuthority() && !CharacterOwner->IsLocallyControlled())
+  {
+    INC_DWORD_STAT(STAT_CMCTest_ServerMoves);
+    CSV_CUSTOM_STAT(CMCTest, ServerMoves, 1, ECsvCustomStatOp::Accumulate);
+  }
+
+  auto recording = GetWorld()->GetSubsystem<UMoveRecordingSubsystem>();
+  if (recording && recording->IsRecording())
+  {
+    recording->RecordMove(this, clientTimeStamp, deltaTime, compressedFlags, newAccel);
+  }
+
+  SetCurrentMoveTimeStamp(clientTimeStamp);
+
+  auto moveData = static_cast<FNetworkMoveData *>(GetCurrentNetworkMoveData());
+
+  if (moveData && (compressedFlags & FSavedMove_Character::FLAG_Custom_1))
   {
-    WantsToPull = moveData->WantsToPull;
+    PullTargetActor = moveData->PullTargetActor;
+    PullTargetOffset = moveData->PullTargetOffset;
+
+    // The move can only have been sent after the client saw the target, and no earlier than a rewind allows.
+    auto serverTimeOffset = GetServerTime() - clientTimeStamp;
+    PullTargetTimeOffset = FMath::Clamp(
+        moveData->PullTargetTimeOffset,
+        static_cast<float>(serverTimeOffset) - MaxPullRewindTime,
+        static_cast<float>(serverTimeOffset));
+    HasPullTarget = PullTargetActor.IsValid() && IsPullTargetValid();
   }
 
   Super::MoveAutonomous(clientTimeStamp, deltaTime, compressedFlags, newAccel);
 }
 
+void UCMCTestCharacterMovementComponent::ReplayMove(FNetworkMoveData &moveData, float deltaTime, double serverTime)
+{
+  TGuardValue<TOptional<double>> replayServerTime(ReplayServerTime, serverTime);
+  SetCurrentNetworkMoveData(&moveData);
+  MoveAutonomous(moveData.TimeStamp, deltaTime, moveData.CompressedMoveFlags, moveData.Acceleration);
+  SetCurrentNetworkMoveData(nullptr);
+}
+
 void UCMCTestCharacterMovementComponent::OnMovementUpdated(float deltaSeconds, const FVector &oldLocation, const FVector &oldVelocity)
 {
+  SCOPE_CYCLE_COUNTER(STAT_CMCTest_OnMovementUpdated);
+  CSV_SCOPED_TIMING_STAT(CMCTest, OnMovementUpdated);
+
   Super::OnMovementUpdated(deltaSeconds, oldLocation, oldVelocity);
 
-  if (WantsToPullLocally)
+  if (GetPawnOwner()->IsLocallyControlled() && !CharacterOwner->bClientUpdating)
   {
-    UE_LOG(LogTemp, Warning, TEXT("has auth? %s"), GetOwner()->HasAuthority() ? TEXT("true") : TEXT("false"));
+    WantsToPull = WantsToPullLocally;
   }
 
-  if (GetPawnOwner()->IsLocallyControlled())
+  // Acquisition is only requested by the controlling machine on the rising edge of the input, and never while
+  // replaying saved moves since those carry the target they resolved the first time around.
+  if (!CharacterOwner->bClientUpdating)
   {
-    WantsToPull = WantsToPullLocally;
+    if (WantsToPull && !WasWantingToPull)
+    {
+      PullPressedTime = GetWorld()->GetTimeSeconds();
+
+      if (GetPawnOwner()->IsLocallyControlled())
+      {
+        RequestPullTarget();
+      }
+    }
+    else if (!WantsToPull)
+    {
+      PullTraceHandle = FTraceHandle();
+      HasPullTarget = false;
+    }
+
+    WasWantingToPull = WantsToPull;
   }
 
-  if (!IsPulling && WantsToPull)
+  if (StartPull && !IsPulling && WantsToPull)
   {
-    auto rotation = CharacterOwner->GetViewRotation().Vector();
-    auto traceStart = CharacterOwner->GetActorLocation() + rotation * 200.f;
-    auto traceEnd = traceStart + rotation * 2000.f;
-    FCollisionQueryParams queryParams;
-    TArray<TEnumAsByte<EObjectTypeQuery>> traceObjectTypes;
-    FHitResult hit;
-
-    if (GetWorld()->LineTraceSingleByObjectType(hit, traceStart, traceEnd, traceObjectTypes, queryParams))
+    // The server only falls back to a synchronous trace when the client's target could not be resolved or does not
+    // hold up against where the target was when the client saw it.
+    if ((HasPullTarget && PullTargetActor.IsValid()) || TracePullTarget())
     {
-      IsPulling = true;
-      HitActor = hit.GetActor();
-      OffsetOnActor = hit.Location - HitActor->GetActorLocation();
-      PullSpeed = 0.f;
+      BeginPull();
     }
   }
   else if (IsPulling && !WantsToPull)
   {
+    CMCTEST_TRACE_EVENT(PullStopped);
     IsPulling = false;
   }
 
-  if (IsPulling)
+  StartPull = false;
+}
+
+void UCMCTestCharacterMovementComponent::UpdateFromCompressedFlags(uint8 flags)
+{
+  Super::UpdateFromCompressedFlags(flags);
+
+  WantsToPull = (flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+  StartPull = (flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+}
+
+void UCMCTestCharacterMovementComponent::OnClientCorrectionReceived(
+    FNetworkPredictionData_Client_Character &clientData,
+    float timeStamp,
+    FVector newLocation,
+    FVector newVelocity,
+    UPrimitiveComponent *newBase,
+    FName newBaseBoneName,
+    bool hasBase,
+    bool baseRelativePosition,
+    uint8 serverMovementMode,
+    FVector serverGravityDirection)
+{
+  Super::OnClientCorrectionReceived(
+      clientData,
+      timeStamp,
+      newLocation,
+      newVelocity,
+      newBase,
+      newBaseBoneName,
+      hasBase,
+      baseRelativePosition,
+      serverMovementMode,
+      serverGravityDirection);
+
+  CMCTEST_TRACE_EVENT(CorrectionReceived);
+  INC_DWORD_STAT(STAT_CMCTest_CorrectionsReceived);
+  CSV_CUSTOM_STAT(CMCTest, CorrectionsReceived, 1, ECsvCustomStatOp::Accumulate);
+}
+
+void UCMCTestCharacterMovementComponent::ServerMovePacked_ClientSend(const FCharacterServerMovePackedBits &packedBits)
+{
+  // Measured once the moves have been packed, so the count covers exactly what goes out in the RPC.
+  auto bytes = FMath::DivideAndRoundUp(packedBits.DataBits.Num(), 8);
+  INC_DWORD_STAT_BY(STAT_CMCTest_MoveBytesWritten, bytes);
+  CSV_CUSTOM_STAT(CMCTest, MoveBytesWritten, bytes, ECsvCustomStatOp::Accumulate);
+
+  Super::ServerMovePacked_ClientSend(packedBits);
+}
+
+void UCMCTestCharacterMovementComponent::ServerSendMoveResponse(const FClientAdjustment &pendingAdjustment)
+{
+  Super::ServerSendMoveResponse(pendingAdjustment);
+
+  if (!pendingAdjustment.bAckGoodMove)
+  {
+    INC_DWORD_STAT(STAT_CMCTest_CorrectionsSent);
+    CSV_CUSTOM_STAT(CMCTest, CorrectionsSent, 1, ECsvCustomStatOp::Accumulate);
+  }
+}
+
+void UCMCTestCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float deltaSeconds)
+{
+  Super::UpdateCharacterStateBeforeMovement(deltaSeconds);
+
+  // The pull is entered and left here, before movement, so both happen on the same move everywhere.
+  if (IsPulling && !IsCustomMovementMode(CMOVE_Pull))
   {
-    PullSpeed = FMath::Min(PullSpeed + PullAcceleration * deltaSeconds, MaxPullSpeed);
+    SetMovementMode(MOVE_Custom, CMOVE_Pull);
+  }
+  else if (!IsPulling && IsCustomMovementMode(CMOVE_Pull))
+  {
+    // Leaving through falling keeps the pull's momentum.
+    SetMovementMode(MOVE_Falling);
+  }
+}
 
-    auto ownerLocation = GetActorLocation();
-    auto pullPoint = HitActor->GetActorLocation() + OffsetOnActor;
-    auto distance = pullPoint - ownerLocation;
-    auto direction = distance.GetSafeNormal();
-    auto velocity = direction * PullSpeed;
+void UCMCTestCharacterMovementComponent::PhysCustom(float deltaTime, int32 iterations)
+{
+  Super::PhysCustom(deltaTime, iterations);
 
-    Launch(velocity);
+  switch (CustomMovementMode)
+  {
+  case CMOVE_Pull:
+    PhysPull(deltaTime, iterations);
+    break;
+  default:
+    break;
   }
-}
\ No newline at end of file
+}
+
+bool UCMCTestCharacterMovementComponent::IsCustomMovementMode(ECustomMovementMode customMode) const
+{
+  return MovementMode == MOVE_Custom && CustomMovementMode == customMode;
+}
+
+void UCMCTestCharacterMovementComponent::GetPullTrace(FVector &traceStart, FVector &traceEnd) const
+{
+  auto rotation = CharacterOwner->GetViewRotation().Vector();
+  traceStart = CharacterOwner->GetActorLocation() + rotation * 200.f;
+  traceEnd = traceStart + rotation * 2000.f;
+}
+
+void UCMCTestCharacterMovementComponent::AimAcquisitionTrace(const FVector &traceStart, FVector &traceEnd) const
+{
+  auto pullTargets = GetWorld()->GetSubsystem<UPullTargetSubsystem>();
+  if (!pullTargets || PullConeHalfAngle <= 0.f)
+  {
+    return;
+  }
+
+  auto direction = (traceEnd - traceStart).GetSafeNormal();
+  auto range = FVector::Dist(traceStart, traceEnd);
+  FVector center;
+
+  if (!pullTargets->FindTargetInCone(traceStart, direction, range, PullConeHalfAngle, CharacterOwner, center))
+  {
+    return;
+  }
+
+  // Aim through the middle of the target, no further than the view trace would have reached. Whatever the trace hits
+  // first is pulled, as it would have been when aiming straight at the target.
+  traceEnd = traceStart + (center - traceStart).GetSafeNormal() * range;
+}
+
+void UCMCTestCharacterMovementComponent::RequestPullTarget()
+{
+  SCOPE_CYCLE_COUNTER(STAT_CMCTest_PullTrace);
+  CSV_SCOPED_TIMING_STAT(CMCTest, PullTrace);
+
+  FVector traceStart, traceEnd;
+  GetPullTrace(traceStart, traceEnd);
+  AimAcquisitionTrace(traceStart, traceEnd);
+  FCollisionQueryParams queryParams(SCENE_QUERY_STAT(PullTarget), false, CharacterOwner);
+
+  HasPullTarget = false;
+  PullTraceHandle = GetWorld()->AsyncLineTraceByChannel(
+      EAsyncTraceType::Single,
+      traceStart,
+      traceEnd,
+      ECC_Visibility,
+      queryParams,
+      FCollisionResponseParams::DefaultResponseParam,
+      &PullTraceDelegate);
+}
+
+bool UCMCTestCharacterMovementComponent::TracePullTarget()
+{
+  CSV_SCOPED_TIMING_STAT(CMCTest, PullTrace);
+
+  FVector viewStart, viewEnd;
+  GetPullTrace(viewStart, viewEnd);
+  FHitResult hit;
+  bool hasHit;
+
+  // Client moves are received before anything ticks, so targets are where the frame pass saw them and the same view
+  // traces the same way.
+  if (PullAcquisition.Frame == GFrameCounter && PullAcquisition.ViewStart == viewStart &&
+      PullAcquisition.ViewEnd == viewEnd)
+  {
+    hit = PullAcquisition.Hit;
+    hasHit = PullAcquisition.HasHit;
+  }
+  else
+  {
+    hasHit = TraceAcquisition(viewStart, viewEnd, hit);
+  }
+
+  if (!hasHit || !hit.GetActor())
+  {
+    return false;
+  }
+
+  CMCTEST_TRACE_EVENT(PullTargetAcquired);
+  PullTargetActor = hit.GetActor();
+  PullTargetOffset = hit.Location - hit.GetActor()->GetActorLocation();
+  HasPullTarget = true;
+  return true;
+}
+
+bool UCMCTestCharacterMovementComponent::TraceAcquisition(
+    const FVector &viewStart,
+    const FVector &viewEnd,
+    FHitResult &outHit) const
+{
+  SCOPE_CYCLE_COUNTER(STAT_CMCTest_PullTrace);
+
+  auto traceEnd = viewEnd;
+  AimAcquisitionTrace(viewStart, traceEnd);
+  FCollisionQueryParams queryParams(SCENE_QUERY_STAT(PullTarget), false, CharacterOwner);
+  return GetWorld()->LineTraceSingleByChannel(outHit, viewStart, traceEnd, ECC_Visibility, queryParams);
+}
+
+bool UCMCTestCharacterMovementComponent::IsAcquiringPullTarget() const
+{
+  return WantsToPull && !IsPulling && GetWorld()->GetTimeSeconds() - PullPressedTime <= MaxPullRewindTime;
+}
+
+bool UCMCTestCharacterMovementComponent::IsPullTargetValid() const
+{
+  // Moving targets are checked where the client saw them, at the server time its move aimed at, not where they are now.
+  // The offset has been clamped to the rewind limit by now, so a client can't reach further back than that.
+  auto currentLocation = PullTargetActor->GetActorLocation();
+  auto targetLocation = currentLocation;
+  auto pullTargets = GetWorld()->GetSubsystem<UPullTargetSubsystem>();
+
+  if (pullTargets)
+  {
+    targetLocation = pullTargets->GetLocationAt(PullTargetActor.Get(), GetMoveServerTime(PullTargetTimeOffset));
+  }
+
+  FVector traceStart, traceEnd;
+  GetPullTrace(traceStart, traceEnd);
+
+  auto pullPoint = targetLocation + PullTargetOffset;
+  auto maxDistance = FVector::Dist(CharacterOwner->GetActorLocation(), traceEnd) + PullTargetTolerance;
+
+  if (FVector::DistSquared(CharacterOwner->GetActorLocation(), pullPoint) > FMath::Square(maxDistance))
+  {
+    return false;
+  }
+
+  auto bounds = PullTargetActor->GetComponentsBoundingBox();
+  if (!bounds.IsValid)
+  {
+    return true;
+  }
+
+  return bounds.ShiftBy(targetLocation - currentLocation).ExpandBy(PullBoundsTolerance).IsInsideOrOn(pullPoint);
+}
+
+void UCMCTestCharacterMovementComponent::OnPullTraceCompleted(const FTraceHandle &handle, FTraceDatum &datum)
+{
+  if (handle != PullTraceHandle)
+  {
+    return;
+  }
+
+  PullTraceHandle = FTraceHandle();
+
+  auto hit = datum.OutHits.Num() > 0 ? &datum.OutHits[0] : nullptr;
+  if (!hit || !hit->bBlockingHit || !hit->GetActor() || !CharacterOwner)
+  {
+    return;
+  }
+
+  CMCTEST_TRACE_EVENT(PullTargetAcquired);
+  PullTargetActor = hit->GetActor();
+  PullTargetOffset = hit->Location - hit->GetActor()->GetActorLocation();
+  HasPullTarget = true;
+
+  // The owning client picks the move the pull starts on; the server and any replays follow the flag it records.
+  if (CharacterOwner->IsLocallyControlled())
+  {
+    StartPull = true;
+  }
+}
+
+void UCMCTestCharacterMovementComponent::BeginPull()
+{
+  CMCTEST_TRACE_EVENT(PullStarted);
+  INC_DWORD_STAT(STAT_CMCTest_PullsStarted);
+  CSV_CUSTOM_STAT(CMCTest, PullsStarted, 1, ECsvCustomStatOp::Accumulate);
+
+  IsPulling = true;
+  HasPullTarget = false;
+  HitActor = PullTargetActor;
+  OffsetOnActor = PullTargetOffset;
+  PullTimeOffset = PullTargetTimeOffset;
+  PullSpeed = 0.f;
+  // Don't reuse a snapshot left over from an earlier pull on the same target.
+  PullTargetSnapshot = FPullTargetSnapshot();
+}
+
+FVector UCMCTestCharacterMovementComponent::GetPullTargetLocation(double serverTime) const
+{
+  // The snapshot only saves looking up an oscillator, which is then evaluated exactly as the oscillator itself would
+  // on a client. Everything else, including pulls that started this frame, is asked the same way on every machine.
+  auto pullTargets = GetWorld()->GetSubsystem<UPullTargetSubsystem>();
+  FVector location;
+
+  if (pullTargets && PullTargetSnapshot.Target == HitActor.Get() &&
+      pullTargets->EvaluateSnapshot(PullTargetSnapshot, serverTime, location))
+  {
+    return location;
+  }
+
+  return IPullTarget::GetLocationAt(HitActor.Get(), serverTime);
+}
+
+FPullStep UCMCTestCharacterMovementComponent::ComputePullStep(
+    const FVector &targetLocation,
+    const FVector &location,
+    float speed,
+    float deltaTime) const
+{
+  FPullStep step;
+  step.PullPoint = targetLocation + OffsetOnActor;
+  step.Direction = (step.PullPoint - location).GetSafeNormal();
+  step.Speed = FMath::Min(speed + PullAcceleration * deltaTime, MaxPullSpeed);
+  return step;
+}
+
+bool UCMCTestCharacterMovementComponent::TakeFramePassStep(
+    double targetTime,
+    const FVector &location,
+    float deltaTime,
+    FPullStep &outStep)
+{
+  auto &snapshot = PullTargetSnapshot;
+
+  // The frame pass evaluated the same oscillator at the same time, so matching inputs give exactly the step this
+  // would have computed.
+  if (!snapshot.HasStep || snapshot.Target != HitActor.Get() || snapshot.StepTime != targetTime ||
+      snapshot.StepStart != location || snapshot.StepStartSpeed != PullSpeed || snapshot.StepDeltaTime != deltaTime)
+  {
+    return false;
+  }
+
+  snapshot.HasStep = false;
+  outStep = snapshot.Step;
+  return true;
+}
+
+void UCMCTestCharacterMovementComponent::SetCurrentMoveTimeStamp(float timeStamp)
+{
+  auto delta = timeStamp - CurrentMoveTimeStamp;
+
+  // Same test the engine uses to spot a reset on the server. Moves from before the reset can still be replayed after
+  // it, which jumps the other way.
+  if (FMath::Abs(delta) > MinTimeBetweenTimeStampResets * 0.5f)
+  {
+    auto shift = delta < 0.f ? MinTimeBetweenTimeStampResets : -MinTimeBetweenTimeStampResets;
+    PullTimeOffset += shift;
+    PullTargetTimeOffset += shift;
+  }
+
+  CurrentMoveTimeStamp = timeStamp;
+}
+
+double UCMCTestCharacterMovementComponent::GetServerTime() const
+{
+  if (ReplayServerTime)
+  {
+    return *ReplayServerTime;
+  }
+
+  auto gameState = GetWorld()->GetGameState();
+  return gameState ? gameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+double UCMCTestCharacterMovementComponent::GetMoveServerTime(float timeOffset) const
+{
+  // Locally controlled pawns on the authority, in standalone, on a listen server's host, or run by AI, move without
+  // saved moves, so nothing stamps their moves. They move at the frame's time, which is already the server's.
+  if (!ReplayServerTime && CharacterOwner->IsLocallyControlled() && CharacterOwner->HasAuthority())
+  {
+    return GetServerTime();
+  }
+
+  return static_cast<double>(CurrentMoveTimeStamp) + timeOffset;
+}
+
+void UCMCTestCharacterMovementComponent::PhysPull(float deltaTime, int32 iterations)
+{
+  if (deltaTime < MIN_TICK_TIME)
+  {
+    return;
+  }
+
+  auto remainingTime = deltaTime;
+
+  // Sub-stepped so the trajectory doesn't depend on frame rate, which keeps the server and client in agreement.
+  while (remainingTime >= MIN_TICK_TIME && iterations < MaxSimulationIterations && IsCustomMovementMode(CMOVE_Pull))
+  {
+    // Also leaves the pull when the target is destroyed partway through.
+    if (!IsPulling || !HitActor.IsValid())
+    {
+      CMCTEST_TRACE_EVENT(PullStopped);
+      IsPulling = false;
+      SetMovementMode(MOVE_Falling);
+      StartNewPhysics(remainingTime, iterations);
+      return;
+    }
+
+    iterations++;
+    auto timeTick = GetSimulationTimeStep(remainingTime, iterations);
+    remainingTime -= timeTick;
+
+    // Aim where the target is at the end of this step, on the clock the client and server share for this pull.
+    auto targetTime = GetMoveServerTime(PullTimeOffset) - remainingTime;
+    auto location = UpdatedComponent->GetComponentLocation();
+    FPullStep step;
+
+    if (!TakeFramePassStep(targetTime, location, timeTick, step))
+    {
+      step = ComputePullStep(GetPullTargetLocation(targetTime), location, PullSpeed, timeTick);
+    }
+
+    auto toPullPoint = step.PullPoint - location;
+    PullSpeed = step.Speed;
+    Velocity = step.Direction * PullSpeed;
+
+    // Never step past the pull point, otherwise the character oscillates around it.
+    auto delta = Velocity * timeTick;
+    if (delta.SizeSquared() > toPullPoint.SizeSquared())
+    {
+      delta = toPullPoint;
+    }
+
+    auto oldLocation = UpdatedComponent->GetComponentLocation();
+    FHitResult hit(1.f);
+    SafeMoveUpdatedComponent(delta, UpdatedComponent->GetComponentQuat(), true, hit);
+
+    if (hit.Time < 1.f)
+    {
+      HandleImpact(hit, timeTick, delta);
+      SlideAlongSurface(delta, 1.f - hit.Time, hit.Normal, hit, true);
+    }
+
+    // Velocity reflects what actually happened, so sliding along a wall doesn't carry into the wall on release.
+    if (!bJustTeleported)
+    {
+      Velocity = (UpdatedComponent->GetComponentLocation() - oldLocation) / timeTick;
+    }
+  }
+}
@@ -2,8 +2,18 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "PullTargetSubsystem.h"
+#include "WorldCollision.h"
 #include "CMCTestCharacterMovementComponent.generated.h"
 
+UENUM(BlueprintType)
+enum ECustomMovementMode
+{
+  CMOVE_None UMETA(Hidden),
+  CMOVE_Pull UMETA(DisplayName = "Pull"),
+  CMOVE_MAX UMETA(Hidden),
+};
+
 class FCharacterSavedMove : public FSavedMove_Character
 {
   typedef FSavedMove_Character Super;
@@ -11,8 +21,28 @@ class FCharacterSavedMove : public FSavedMove_Character
 public:
   bool WantsToPull;
 
+  // Set on the move where the pull began, along with the target the client resolved for it.
+  bool StartPull;
+  TWeakObjectPtr<AActor> PullTargetActor;
+  FVector PullTargetOffset;
+  float PullTargetTimeOffset;
+
+  // Pull state at the start of the move, restored before replaying it.
+  bool StartIsPulling;
+  float StartPullSpeed;
+  TWeakObjectPtr<AActor> StartHitActor;
+  FVector StartOffsetOnActor;
+  float StartPullTimeOffset;
+
+  virtual uint8 GetCompressedFlags() const override;
+
 protected:
   virtual bool CanCombineWith(const FSavedMovePtr &newMove, ACharacter *inCharacter, float maxDelta) const override;
+  virtual void CombineWith(
+      const FSavedMove_Character *oldMove,
+      ACharacter *inCharacter,
+      APlayerController *playerController,
+      const FVector &oldStartLocation) override;
   virtual void Clear() override;
   virtual void SetMoveFor(
       ACharacter *character,
@@ -27,7 +57,10 @@ class FNetworkMoveData : public FCharacterNetworkMoveData
 public:
   typedef FCharacterNetworkMoveData Super;
 
-  bool WantsToPull;
+  // Pull intent travels in the compressed flags; the target block is only serialized on the move that starts the pull.
+  AActor *PullTargetActor;
+  FVector PullTargetOffset;
+  float PullTargetTimeOffset;
 
   virtual void ClientFillNetworkMoveData(const FSavedMove_Character &clientMove, ENetworkMoveType moveType) override;
   virtual bool Serialize(
@@ -57,24 +90,118 @@ class UCMCTestCharacterMovementComponent : public UCharacterMovementComponent
 {
   GENERATED_BODY()
 
+  friend struct FPullTestAccess;
+
 protected:
   FNetworkMoveDataContainer MoveDataContainer;
 
 public:
   UCMCTestCharacterMovementComponent(const FObjectInitializer &objectInitializer);
   virtual void BeginPlay() override;
+  virtual void EndPlay(const EEndPlayReason::Type endPlayReason) override;
   virtual FNetworkPredictionData_Client *GetPredictionData_Client() const override;
   virtual void MoveAutonomous(float clientTimeStamp, float deltaTime, uint8 compressedFlags, const FVector &newAccel)
       override;
   virtual void OnMovementUpdated(float deltaSeconds, const FVector &oldLocation, const FVector &oldVelocity) override;
+  virtual void UpdateFromCompressedFlags(uint8 flags) override;
+  virtual void OnClientCorrectionReceived(
+      FNetworkPredictionData_Client_Character &clientData,
+      float timeStamp,
+      FVector newLocation,
+      FVector newVelocity,
+      UPrimitiveComponent *newBase,
+      FName newBaseBoneName,
+      bool hasBase,
+      bool baseRelativePosition,
+      uint8 serverMovementMode,
+      FVector serverGravityDirection) override;
+  virtual void ServerMovePacked_ClientSend(const FCharacterServerMovePackedBits &packedBits) override;
+  virtual void ServerSendMoveResponse(const FClientAdjustment &pendingAdjustment) override;
+
+  // Runs a recorded move as if it had just arrived from the owning client at the given server time.
+  void ReplayMove(FNetworkMoveData &moveData, float deltaTime, double serverTime);
+  virtual void UpdateCharacterStateBeforeMovement(float deltaSeconds) override;
+  virtual void PhysCustom(float deltaTime, int32 iterations) override;
+
+  UFUNCTION(BlueprintPure)
+  bool IsCustomMovementMode(ECustomMovementMode customMode) const;
 
   bool WantsToPullLocally;
   bool WantsToPull;
 
+  // Begin pulling toward PullTargetActor on this move. Set by the owning client once acquisition resolves, and
+  // replayed from the saved move or network move everywhere else, so every machine starts the pull on the same move.
+  bool StartPull;
+  bool HasPullTarget;
+  // Weak, since targets can be destroyed while a pull toward them is pending or underway.
+  TWeakObjectPtr<AActor> PullTargetActor;
+  FVector PullTargetOffset;
+  // Server time minus move timestamp when the pull started. Adding it to a move's timestamp gives the server time the
+  // move is aiming at, which comes out the same on the client and the server.
+  float PullTargetTimeOffset;
+
   bool IsPulling;
-  AActor *HitActor;
+  TWeakObjectPtr<AActor> HitActor;
   FVector OffsetOnActor;
+  float PullTimeOffset;
+  // Set by the server's frame pass at the start of each frame. Used when it matches HitActor, and its step taken by
+  // the first matching sub-step of PhysPull.
+  FPullTargetSnapshot PullTargetSnapshot;
+  // Set by the server's frame pass while the character is about to pull. See IsAcquiringPullTarget.
+  FPullAcquisition PullAcquisition;
+  // World time the pull input was last pressed, as seen by the machine running the moves.
+  double PullPressedTime;
+  // Timestamp of the move being performed, which is the time at its end.
+  float CurrentMoveTimeStamp;
+  // Moves on to the timestamp of a new move. Clients wrap their timestamps every MinTimeBetweenTimeStampResets, so a
+  // jump of more than half that shifts the pull time offsets by the same amount to keep aiming at the same server time.
+  void SetCurrentMoveTimeStamp(float timeStamp);
   float PullSpeed;
   float MaxPullSpeed = 2000;
   float PullAcceleration = 4000;
+
+  // Half angle of the view cone searched for registered pull targets, in degrees. The trace is aimed at the best one
+  // found, and only follows the view when there is none. Zero always traces along the view.
+  float PullConeHalfAngle = 8.f;
+
+  // How far past the acquisition trace a client-reported pull point may lie before the server retraces instead.
+  float PullTargetTolerance = 200;
+  // How far outside the target's rewound bounds a client-reported pull point may lie.
+  float PullBoundsTolerance = 32;
+  // Upper bound on how far back the server rewinds pull targets to match what a client saw.
+  float MaxPullRewindTime = 0.25f;
+
+  // One pull step toward the target's location at the step's time. PhysPull steps with this, and the server's frame
+  // pass calls it from worker threads, so it only reads this component's pull settings and OffsetOnActor.
+  FPullStep ComputePullStep(const FVector &targetLocation, const FVector &location, float speed, float deltaTime) const;
+
+  // True for a short while after the pull input is pressed, until the pull starts, when the owning client's move
+  // starting it may need the server's fallback trace.
+  bool IsAcquiringPullTarget() const;
+
+  void GetPullTrace(FVector &traceStart, FVector &traceEnd) const;
+  // Aims the view trace at the best target in the pull cone, then traces. Safe on worker threads while the game
+  // thread waits.
+  bool TraceAcquisition(const FVector &viewStart, const FVector &viewEnd, FHitResult &outHit) const;
+
+protected:
+  void AimAcquisitionTrace(const FVector &traceStart, FVector &traceEnd) const;
+  void RequestPullTarget();
+  bool TracePullTarget();
+  bool IsPullTargetValid() const;
+  void OnPullTraceCompleted(const FTraceHandle &handle, FTraceDatum &datum);
+  void BeginPull();
+  void PhysPull(float deltaTime, int32 iterations);
+  double GetServerTime() const;
+  // Server time at the end of the move being performed, for moves stamped against the given pull time offset.
+  double GetMoveServerTime(float timeOffset) const;
+  FVector GetPullTargetLocation(double serverTime) const;
+  // The step the frame pass computed, if this sub-step starts where, when and how the pass expected. Taken once.
+  bool TakeFramePassStep(double targetTime, const FVector &location, float deltaTime, FPullStep &outStep);
+
+  TOptional<double> ReplayServerTime;
+
+  bool WasWantingToPull;
+  FTraceHandle PullTraceHandle;
+  FTraceDelegate PullTraceDelegate;
 };
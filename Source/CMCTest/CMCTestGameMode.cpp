@@ -1,14 +1,170 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CMCTestGameMode.h"
+#include "AssetPreloadSubsystem.h"
+#include "CMCTest.h"
 #include "CMCTestCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/PlayerController.h"
+
+namespace
+{
+	constexpr float NetUpdateLODInterval = 0.5f;
+}
 
 ACMCTestGameMode::ACMCTestGameMode()
 	: Super()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnClassFinder(TEXT("/Game/FirstPerson/Blueprints/BP_FirstPersonCharacter"));
-	DefaultPawnClass = PlayerPawnClassFinder.Class;
+	// set default pawn class to our Blueprinted character, once it has been loaded in the background
+	PlayerPawnClass = TSoftClassPtr<APawn>(FSoftObjectPath(TEXT("/Game/FirstPerson/Blueprints/BP_FirstPersonCharacter.BP_FirstPersonCharacter_C")));
+
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void ACMCTestGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	// Start loading now, since local players join before the world begins play
+	if (UAssetPreloadSubsystem* Preload = GetWorld()->GetSubsystem<UAssetPreloadSubsystem>())
+	{
+		Preload->StartPreload();
+		Preload->CallWhenReady(FSimpleDelegate::CreateUObject(this, &ACMCTestGameMode::OnAssetsPreloaded));
+	}
+	else
+	{
+		OnAssetsPreloaded();
+	}
+}
+
+void ACMCTestGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	// Hold players back until their pawn and weapons can be used without loading anything
+	if (!bAssetsPreloaded)
+	{
+		PendingPlayers.Add(NewPlayer);
+		return;
+	}
+
+	Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+}
+
+void ACMCTestGameMode::GetAssetsToPreload(TArray<FSoftObjectPath>& OutPaths) const
+{
+	OutPaths.Add(PlayerPawnClass.ToSoftObjectPath());
+}
+
+void ACMCTestGameMode::OnAssetsPreloaded()
+{
+	bAssetsPreloaded = true;
+
+	// Keep a pawn class that a Blueprint subclass has set in place of the native default
+	UClass* LoadedPawnClass = PlayerPawnClass.Get();
+	if (LoadedPawnClass != nullptr && DefaultPawnClass == GetDefault<ACMCTestGameMode>()->DefaultPawnClass)
+	{
+		DefaultPawnClass = LoadedPawnClass;
+	}
+
+	TArray<TObjectPtr<APlayerController>> Players = MoveTemp(PendingPlayers);
+	for (APlayerController* Player : Players)
+	{
+		if (IsValid(Player))
+		{
+			Super::HandleStartingNewPlayer_Implementation(Player);
+		}
+	}
+}
+
+void ACMCTestGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	NetUpdateLODTimer -= DeltaSeconds;
+	if (GetNetMode() != NM_Standalone && NetUpdateLODTimer <= 0.f)
+	{
+		NetUpdateLODTimer = NetUpdateLODInterval;
+		UpdateCharacterNetUpdateLODs();
+	}
+
+#if CSV_PROFILER
+	// Per-client bandwidth for soak runs, which only capture CSVs on the server
+	if (UNetDriver* NetDriver = GetWorld()->GetNetDriver())
+	{
+		const int32 Clients = NetDriver->ClientConnections.Num();
+		CSV_CUSTOM_STAT(CMCTest, Clients, Clients, ECsvCustomStatOp::Set);
+
+		if (Clients > 0)
+		{
+			CSV_CUSTOM_STAT(CMCTest, OutBytesPerClientPerSecond, static_cast<float>(NetDriver->OutBytesPerSecond) / Clients, ECsvCustomStatOp::Set);
+			CSV_CUSTOM_STAT(CMCTest, InBytesPerClientPerSecond, static_cast<float>(NetDriver->InBytesPerSecond) / Clients, ECsvCustomStatOp::Set);
+		}
+	}
+#endif
+}
+
+void ACMCTestGameMode::UpdateCharacterNetUpdateLODs()
+{
+	TArray<APawn*> Pawns;
+	TArray<FVector> Locations;
+	float CellSize = 0.f;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APawn* Pawn = It->IsValid() ? (*It)->GetPawn() : nullptr;
+		if (Pawn != nullptr)
+		{
+			Pawns.Add(Pawn);
+			Locations.Add(Pawn->GetActorLocation());
+
+			if (const ACMCTestCharacter* Character = Cast<ACMCTestCharacter>(Pawn))
+			{
+				CellSize = FMath::Max(CellSize, Character->FarLODDistance);
+			}
+		}
+	}
+
+	if (CellSize <= 0.f)
+	{
+		return;
+	}
+
+	// Anyone beyond the far LOD distance counts as far, so each pawn only needs the pawns in the cells around its own
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+	TArray<FIntPoint> PawnCells;
+	PawnCells.Reserve(Pawns.Num());
+	for (int32 Index = 0; Index < Pawns.Num(); Index++)
+	{
+		const FIntPoint Cell(FMath::FloorToInt32(Locations[Index].X / CellSize), FMath::FloorToInt32(Locations[Index].Y / CellSize));
+		PawnCells.Add(Cell);
+		Cells.FindOrAdd(Cell).Add(Index);
+	}
+
+	for (int32 Index = 0; Index < Pawns.Num(); Index++)
+	{
+		ACMCTestCharacter* Character = Cast<ACMCTestCharacter>(Pawns[Index]);
+		if (Character == nullptr)
+		{
+			continue;
+		}
+
+		double NearestDistanceSquared = TNumericLimits<float>::Max();
+		for (int32 Y = -1; Y <= 1; Y++)
+		{
+			for (int32 X = -1; X <= 1; X++)
+			{
+				if (const auto* Neighbours = Cells.Find(PawnCells[Index] + FIntPoint(X, Y)))
+				{
+					for (int32 Other : *Neighbours)
+					{
+						if (Other != Index)
+						{
+							NearestDistanceSquared = FMath::Min(NearestDistanceSquared, FVector::DistSquared(Locations[Index], Locations[Other]));
+						}
+					}
+				}
+			}
+		}
 
+		Character->SetNetUpdateLOD(Character->GetLODForDistance(static_cast<float>(FMath::Sqrt(NearestDistanceSquared))));
+	}
 }
@@ -13,6 +13,32 @@ class ACMCTestGameMode : public AGameModeBase
 
 public:
 	ACMCTestGameMode();
+
+	/** Pawn spawned for players, loaded in the background before any of them start */
+	UPROPERTY(EditDefaultsOnly, Category=Classes)
+	TSoftClassPtr<APawn> PlayerPawnClass;
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Adds the assets players need from the start, for the preload subsystem */
+	void GetAssetsToPreload(TArray<FSoftObjectPath>& OutPaths) const;
+
+private:
+	/** Starts the players that joined while assets were loading */
+	void OnAssetsPreloaded();
+
+	/** Lowers how often each character replicates when no other player is near it */
+	void UpdateCharacterNetUpdateLODs();
+
+	/** Players waiting for assets to load before they can start */
+	UPROPERTY()
+	TArray<TObjectPtr<APlayerController>> PendingPlayers;
+
+	bool bAssetsPreloaded = false;
+
+	float NetUpdateLODTimer = 0.f;
 };
 
 
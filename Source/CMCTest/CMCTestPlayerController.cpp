@@ -4,6 +4,7 @@
 #include "CMCTestPlayerController.h"
 #include "EnhancedInputSubsystems.h"
 #include "Engine/LocalPlayer.h"
+#include "SignificanceManager.h"
 
 void ACMCTestPlayerController::BeginPlay()
 {
@@ -15,4 +16,19 @@ void ACMCTestPlayerController::BeginPlay()
 		// add the mapping context so we get controls
 		Subsystem->AddMappingContext(InputMappingContext, 0);
 	}
+}
+
+void ACMCTestPlayerController::PlayerTick(float DeltaTime)
+{
+	Super::PlayerTick(DeltaTime);
+
+	if (USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld()))
+	{
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		const FTransform Viewpoint(ViewRotation, ViewLocation);
+		SignificanceManager->Update(MakeArrayView(&Viewpoint, 1));
+	}
 }
\ No newline at end of file
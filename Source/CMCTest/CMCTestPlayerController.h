@@ -28,4 +28,11 @@ protected:
 	virtual void BeginPlay() override;
 
 	// End Actor interface
+
+	// Begin PlayerController interface
+
+	/** Ranks other characters against this player's view for their LOD */
+	virtual void PlayerTick(float DeltaTime) override;
+
+	// End PlayerController interface
 };
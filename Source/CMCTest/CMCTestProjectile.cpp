@@ -3,6 +3,8 @@
 #include "CMCTestProjectile.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
+#include "ImpulseBatchSubsystem.h"
+#include "ProjectilePoolSubsystem.h"
 
 ACMCTestProjectile::ACMCTestProjectile() 
 {
@@ -33,11 +35,71 @@ ACMCTestProjectile::ACMCTestProjectile()
 
 void ACMCTestProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
-	// Only add impulse and destroy projectile if we hit a physics
+	// Only add impulse and recycle projectile if we hit a physics
 	if ((OtherActor != nullptr) && (OtherActor != this) && (OtherComp != nullptr) && OtherComp->IsSimulatingPhysics())
 	{
-		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
+		// Impulses are applied once per body at the end of the frame
+		if (UImpulseBatchSubsystem* Impulses = GetWorld()->GetSubsystem<UImpulseBatchSubsystem>())
+		{
+			Impulses->AddImpulseAtLocation(OtherComp, GetVelocity() * 100.0f, GetActorLocation());
+		}
 
+		Recycle();
+	}
+}
+
+void ACMCTestProjectile::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	ActiveCollisionEnabled = CollisionComp->GetCollisionEnabled();
+}
+
+void ACMCTestProjectile::LifeSpanExpired()
+{
+	Recycle();
+}
+
+void ACMCTestProjectile::Launch(const FVector& Location, const FRotator& Rotation)
+{
+	bActive = true;
+
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	CollisionComp->SetCollisionEnabled(ActiveCollisionEnabled);
+
+	// Stopping may have cleared the updated component, and the initial velocity is only applied on first initialization
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+	ProjectileMovement->Velocity = Rotation.Vector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->UpdateComponentVelocity();
+	ProjectileMovement->SetActive(true);
+
+	SetLifeSpan(InitialLifeSpan);
+}
+
+void ACMCTestProjectile::Deactivate()
+{
+	bActive = false;
+
+	SetLifeSpan(0.f);
+
+	// Deactivating the movement component also stops it from finishing a bounce if this happens inside a hit
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->SetActive(false);
+
+	CollisionComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetActorHiddenInGame(true);
+}
+
+void ACMCTestProjectile::Recycle()
+{
+	UProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>();
+	if (bPooled && ProjectilePool != nullptr)
+	{
+		ProjectilePool->Release(this);
+	}
+	else
+	{
 		Destroy();
 	}
 }
\ No newline at end of file
@@ -29,6 +29,31 @@ public:
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/** Puts a pooled projectile back in flight from the given transform */
+	void Launch(const FVector& Location, const FRotator& Rotation);
+
+	/** Stops, hides and disables collision on the projectile until it is launched again */
+	void Deactivate();
+
+	/** Returns the projectile to its pool, or destroys it if it was not pooled */
+	void Recycle();
+
+	bool IsActive() const { return bActive; }
+
+	/** Set by the projectile pool on projectiles it owns */
+	bool bPooled = false;
+
+protected:
+	virtual void PostInitializeComponents() override;
+	virtual void LifeSpanExpired() override;
+
+private:
+	bool bActive = true;
+
+	/** Collision setting restored when a pooled projectile is launched again */
+	TEnumAsByte<ECollisionEnabled::Type> ActiveCollisionEnabled;
+
+public:
 	/** Returns CollisionComp subobject **/
 	USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
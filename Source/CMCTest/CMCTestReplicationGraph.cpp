@@ -0,0 +1,232 @@
+#include "CMCTestReplicationGraph.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "OscillatingActor.h"
+
+static TAutoConsoleVariable<bool> CVarReplicationGraphEnabled(
+    TEXT("CMCTest.ReplicationGraph.Enabled"),
+    true,
+    TEXT("Replicate game net drivers through CMCTestReplicationGraph. Turn off, e.g. with -dpcvars on the server's "
+         "command line, to compare against the engine's default replication. Read when a net driver starts."));
+
+UCMCTestReplicationGraph::UCMCTestReplicationGraph()
+{
+  GridCellSize = 10000.f;
+  GridSpatialBias = FVector2D(-200000.f, -200000.f);
+}
+
+UCMCTestReplicationGraph *UCMCTestReplicationGraph::Get(const UWorld *world)
+{
+  auto netDriver = world ? world->GetNetDriver() : nullptr;
+  return netDriver ? netDriver->GetReplicationDriver<UCMCTestReplicationGraph>() : nullptr;
+}
+
+UReplicationDriver *UCMCTestReplicationGraph::CreateReplicationDriver(
+    UNetDriver *netDriver,
+    const FURL &url,
+    UWorld *world)
+{
+  // Only the game net driver gets the graph. Demo recording and beacons keep the engine's default replication.
+  if (!CVarReplicationGraphEnabled.GetValueOnGameThread() || !netDriver ||
+      netDriver->NetDriverName != NAME_GameNetDriver || !world || !world->IsGameWorld())
+  {
+    return nullptr;
+  }
+
+  return NewObject<UCMCTestReplicationGraph>(GetTransientPackage());
+}
+
+void UCMCTestReplicationGraph::InitGlobalActorClassSettings()
+{
+  Super::InitGlobalActorClassSettings();
+
+  // The graph replicates in frames rather than at a frequency, and culls by class, so both come from each class's CDO.
+  for (TObjectIterator<UClass> it; it; ++it)
+  {
+    // Filter before touching the CDO, so classes that can never replicate don't get one made for them.
+    if (!it->IsChildOf(AActor::StaticClass()) ||
+        it->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists))
+    {
+      continue;
+    }
+
+    if (!GetDefault<AActor>(*it)->GetIsReplicated())
+    {
+      continue;
+    }
+
+    SetClassSettingsFromDefaults(*it);
+  }
+}
+
+void UCMCTestReplicationGraph::SetClassSettingsFromDefaults(UClass *actorClass)
+{
+  auto actor = GetDefault<AActor>(actorClass);
+
+  FClassReplicationInfo classInfo;
+  classInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(actor->NetUpdateFrequency);
+  classInfo.SetCullDistanceSquared(
+      actor->bAlwaysRelevant || actor->bOnlyRelevantToOwner ? 0.f : actor->NetCullDistanceSquared);
+  GlobalActorReplicationInfoMap.SetClassInfo(actorClass, classInfo);
+  ClassesWithSettings.Add(actorClass);
+}
+
+void UCMCTestReplicationGraph::InitGlobalGraphNodes()
+{
+  GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+  GridNode->CellSize = GridCellSize;
+  GridNode->SpatialBias = GridSpatialBias;
+  AddGlobalGraphNode(GridNode);
+
+  AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+  AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UCMCTestReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection *connectionManager)
+{
+  Super::InitConnectionGraphNodes(connectionManager);
+
+  auto node = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+  AddConnectionGraphNode(node, connectionManager);
+  OwnerOnlyNodes.Add(connectionManager->NetConnection, node);
+}
+
+void UCMCTestReplicationGraph::RemoveClientConnection(UNetConnection *netConnection)
+{
+  OwnerOnlyNodes.Remove(netConnection);
+  Super::RemoveClientConnection(netConnection);
+}
+
+UCMCTestReplicationGraph::EActorRoute UCMCTestReplicationGraph::GetRoute(const AActor *actor) const
+{
+  if (actor->bAlwaysRelevant)
+  {
+    return EActorRoute::AlwaysRelevant;
+  }
+
+  if (actor->bOnlyRelevantToOwner)
+  {
+    return EActorRoute::OwnerOnly;
+  }
+
+  // Oscillators simulated on clients sit dormant, so the grid treats them as static until they wake.
+  if (actor->IsA<AOscillatingActor>())
+  {
+    return EActorRoute::GridDormancy;
+  }
+
+  return actor->IsRootComponentMovable() ? EActorRoute::GridDynamic : EActorRoute::GridStatic;
+}
+
+UReplicationGraphNode_AlwaysRelevant_ForConnection *UCMCTestReplicationGraph::FindOwnerOnlyNode(
+    const AActor *actor) const
+{
+  auto connection = actor->GetNetConnection();
+  return connection ? OwnerOnlyNodes.FindRef(connection) : nullptr;
+}
+
+void UCMCTestReplicationGraph::RouteAddNetworkActorToNodes(
+    const FNewReplicatedActorInfo &actorInfo,
+    FGlobalActorReplicationInfo &globalInfo)
+{
+  // The actor's info was made from the nearest class with settings, so replace it if its own class is new.
+  auto actorClass = actorInfo.Actor->GetClass();
+  if (!ClassesWithSettings.Contains(actorClass))
+  {
+    SetClassSettingsFromDefaults(actorClass);
+    globalInfo.Settings = GlobalActorReplicationInfoMap.GetClassInfo(actorClass);
+  }
+
+  auto route = GetRoute(actorInfo.Actor);
+  ActorRoutes.Add(actorInfo.Actor, route);
+
+  switch (route)
+  {
+  case EActorRoute::AlwaysRelevant:
+    AlwaysRelevantNode->NotifyAddNetworkActor(actorInfo);
+    break;
+  case EActorRoute::OwnerOnly:
+    if (auto node = FindOwnerOnlyNode(actorInfo.Actor))
+    {
+      node->NotifyAddNetworkActor(actorInfo);
+    }
+    else
+    {
+      UnroutedOwnerOnlyActors.Add(actorInfo.Actor);
+    }
+    break;
+  case EActorRoute::GridStatic:
+    GridNode->AddActor_Static(actorInfo, globalInfo);
+    break;
+  case EActorRoute::GridDynamic:
+    GridNode->AddActor_Dynamic(actorInfo, globalInfo);
+    break;
+  case EActorRoute::GridDormancy:
+    GridNode->AddActor_Dormancy(actorInfo, globalInfo);
+    break;
+  }
+}
+
+void UCMCTestReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo &actorInfo)
+{
+  EActorRoute route;
+  if (!ActorRoutes.RemoveAndCopyValue(actorInfo.Actor, route))
+  {
+    return;
+  }
+
+  switch (route)
+  {
+  case EActorRoute::AlwaysRelevant:
+    AlwaysRelevantNode->NotifyRemoveNetworkActor(actorInfo);
+    break;
+  case EActorRoute::OwnerOnly:
+    // The owner may have changed since the actor was routed, so every connection is checked.
+    if (UnroutedOwnerOnlyActors.RemoveSwap(actorInfo.Actor) == 0)
+    {
+      for (auto &node : OwnerOnlyNodes)
+      {
+        node.Value->NotifyRemoveNetworkActor(actorInfo, false);
+      }
+    }
+    break;
+  case EActorRoute::GridStatic:
+    GridNode->RemoveActor_Static(actorInfo);
+    break;
+  case EActorRoute::GridDynamic:
+    GridNode->RemoveActor_Dynamic(actorInfo);
+    break;
+  case EActorRoute::GridDormancy:
+    GridNode->RemoveActor_Dormancy(actorInfo);
+    break;
+  }
+}
+
+int32 UCMCTestReplicationGraph::ServerReplicateActors(float deltaSeconds)
+{
+  for (int32 i = UnroutedOwnerOnlyActors.Num() - 1; i >= 0; i--)
+  {
+    if (auto node = FindOwnerOnlyNode(UnroutedOwnerOnlyActors[i]))
+    {
+      node->NotifyAddNetworkActor(FNewReplicatedActorInfo(UnroutedOwnerOnlyActors[i]));
+      UnroutedOwnerOnlyActors.RemoveAtSwap(i);
+    }
+  }
+
+  return Super::ServerReplicateActors(deltaSeconds);
+}
+
+void UCMCTestReplicationGraph::SetActorUpdateFrequency(AActor *actor, float netUpdateFrequency)
+{
+  if (auto actorInfo = GlobalActorReplicationInfoMap.Find(actor))
+  {
+    actorInfo->Settings.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(netUpdateFrequency);
+  }
+}
+
+void UCMCTestReplicationGraph::RerouteActor(AActor *actor)
+{
+  RemoveNetworkActor(actor);
+  AddNetworkActor(actor);
+}
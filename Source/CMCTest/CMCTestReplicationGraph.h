@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "CMCTestReplicationGraph.generated.h"
+
+// Replaces the per-actor relevancy scan. Characters, oscillators and projectiles live in a 2D grid, so each connection
+// only gathers the cells around its viewer. Always relevant actors, like the game state, share one global list, and
+// owner-only actors, like a held weapon or a player controller, go to a list on their owner's connection.
+UCLASS(Transient, Config = Engine)
+class UCMCTestReplicationGraph : public UReplicationGraph
+{
+  GENERATED_BODY()
+
+public:
+  UCMCTestReplicationGraph();
+
+  static UCMCTestReplicationGraph *Get(const UWorld *world);
+
+  // Bound to UReplicationDriver::CreateReplicationDriverDelegate at startup. Gives game net drivers the graph unless
+  // CMCTest.ReplicationGraph.Enabled is off, in which case they fall back to the engine's default replication.
+  static UReplicationDriver *CreateReplicationDriver(UNetDriver *netDriver, const FURL &url, UWorld *world);
+
+  virtual void InitGlobalActorClassSettings() override;
+  virtual void InitGlobalGraphNodes() override;
+  virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection *connectionManager) override;
+  virtual void RemoveClientConnection(UNetConnection *netConnection) override;
+  virtual void RouteAddNetworkActorToNodes(
+      const FNewReplicatedActorInfo &actorInfo,
+      FGlobalActorReplicationInfo &globalInfo) override;
+  virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo &actorInfo) override;
+  virtual int32 ServerReplicateActors(float deltaSeconds) override;
+
+  // Routes an actor again after something that decides its node changed, e.g. it became owner-only.
+  void RerouteActor(AActor *actor);
+
+  // The graph replicates from its own per-actor settings, so actors changing NetUpdateFrequency at runtime tell it here.
+  void SetActorUpdateFrequency(AActor *actor, float netUpdateFrequency);
+
+  UPROPERTY(Config)
+  float GridCellSize;
+
+  // Lowest world X and Y the grid expects, so cells start at zero.
+  UPROPERTY(Config)
+  FVector2D GridSpatialBias;
+
+protected:
+  enum class EActorRoute
+  {
+    AlwaysRelevant,
+    OwnerOnly,
+    GridStatic,
+    GridDynamic,
+    GridDormancy,
+  };
+
+  // Sets a class's replication period and cull distance from its CDO.
+  void SetClassSettingsFromDefaults(UClass *actorClass);
+
+  EActorRoute GetRoute(const AActor *actor) const;
+  UReplicationGraphNode_AlwaysRelevant_ForConnection *FindOwnerOnlyNode(const AActor *actor) const;
+
+  UPROPERTY()
+  TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
+
+  UPROPERTY()
+  TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
+
+  UPROPERTY()
+  TMap<TObjectPtr<UNetConnection>, TObjectPtr<UReplicationGraphNode_AlwaysRelevant_ForConnection>> OwnerOnlyNodes;
+
+  // Classes whose settings came from their own CDO. Classes loaded after init, like Blueprint pawns loaded in the
+  // background, would otherwise inherit their native parent's settings.
+  TSet<const UClass *> ClassesWithSettings;
+
+  // The route each actor was added with, so it's removed from the same node even if its flags changed since.
+  TMap<const AActor *, EActorRoute> ActorRoutes;
+
+  // Owner-only actors usually get their owner after they start replicating, so they wait here until it's known.
+  UPROPERTY()
+  TArray<TObjectPtr<AActor>> UnroutedOwnerOnlyActors;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+// Movement and pull events on their own Insights channel, enabled with -trace=default,CMCTest. Events are CPU scopes,
+// so they show up on the timeline next to the frame they happened in. Everything compiles out in shipping.
+#define CMCTEST_TRACE_ENABLED (UE_TRACE_ENABLED && CPUPROFILERTRACE_ENABLED && !UE_BUILD_SHIPPING)
+
+#if CMCTEST_TRACE_ENABLED
+
+UE_TRACE_CHANNEL_EXTERN(CMCTestChannel);
+
+#define CMCTEST_TRACE_EVENT(name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("CMCTest." #name, CMCTestChannel)
+
+#else
+
+#define CMCTEST_TRACE_EVENT(name)
+
+#endif
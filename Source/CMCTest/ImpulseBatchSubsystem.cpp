@@ -0,0 +1,173 @@
+#include "ImpulseBatchSubsystem.h"
+#include "CMCTest.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impulses Queued"), STAT_ImpulsesQueued, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impulse Bodies Applied"), STAT_ImpulseBodiesApplied, STATGROUP_CMCTest);
+
+static FAutoConsoleCommandWithWorldAndArgs ImpulseStressCommand(
+    TEXT("CMCTest.Impulses.Stress"),
+    TEXT("CMCTest.Impulses.Stress <hitsPerSecond> <seconds>: hits simulating bodies in the world through the impulse "
+         "batch and logs the result. Use with stat physics to see the physics cost."),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda(
+        [](const TArray<FString> &args, UWorld *world)
+        {
+          auto hitsPerSecond = args.Num() > 0 ? FCString::Atof(*args[0]) : 1000.f;
+          auto seconds = args.Num() > 1 ? FCString::Atof(*args[1]) : 10.f;
+
+          if (auto impulses = world ? world->GetSubsystem<UImpulseBatchSubsystem>() : nullptr)
+          {
+            impulses->StartStressTest(hitsPerSecond, seconds);
+          }
+        }));
+
+void UImpulseBatchSubsystem::Tick(float deltaSeconds)
+{
+  Super::Tick(deltaSeconds);
+
+  if (StressTimeRemaining > 0)
+  {
+    AddStressHits(deltaSeconds);
+  }
+
+  auto bodies = Components.Num();
+  auto startTime = FPlatformTime::Seconds();
+
+  ApplyImpulses();
+
+  if (StressTimeRemaining > 0)
+  {
+    StressApplySeconds += FPlatformTime::Seconds() - startTime;
+    StressBodiesPushed += bodies;
+    StressFrames++;
+
+    StressTimeRemaining -= deltaSeconds;
+    if (StressTimeRemaining <= 0)
+    {
+      FinishStressTest();
+    }
+  }
+}
+
+TStatId UImpulseBatchSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UImpulseBatchSubsystem, STATGROUP_Tickables);
+}
+
+bool UImpulseBatchSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+  return worldType == EWorldType::Game || worldType == EWorldType::PIE;
+}
+
+void UImpulseBatchSubsystem::AddImpulseAtLocation(
+    UPrimitiveComponent *component,
+    const FVector &impulse,
+    const FVector &location)
+{
+  if (!component)
+  {
+    return;
+  }
+
+  INC_DWORD_STAT(STAT_ImpulsesQueued);
+
+  auto &slot = Slots.FindOrAdd(component, INDEX_NONE);
+  if (slot == INDEX_NONE)
+  {
+    slot = Components.Add(component);
+    LinearImpulses.Add(FVector::ZeroVector);
+    Moments.Add(FVector::ZeroVector);
+  }
+
+  LinearImpulses[slot] += impulse;
+  Moments[slot] += FVector::CrossProduct(location, impulse);
+}
+
+void UImpulseBatchSubsystem::ApplyImpulses()
+{
+  for (int32 i = 0; i < Components.Num(); i++)
+  {
+    auto component = Components[i].Get();
+    if (!component || !component->IsSimulatingPhysics())
+    {
+      continue;
+    }
+
+    // sum((location - com) x impulse) == sum(location x impulse) - com x sum(impulse)
+    auto angularImpulse = Moments[i] - FVector::CrossProduct(component->GetCenterOfMass(), LinearImpulses[i]);
+
+    component->AddImpulse(LinearImpulses[i]);
+    component->AddAngularImpulseInRadians(angularImpulse);
+    INC_DWORD_STAT(STAT_ImpulseBodiesApplied);
+  }
+
+  Slots.Reset();
+  Components.Reset();
+  LinearImpulses.Reset();
+  Moments.Reset();
+}
+
+void UImpulseBatchSubsystem::StartStressTest(float hitsPerSecond, float seconds)
+{
+  StressBodies.Reset();
+
+  for (TActorIterator<AActor> it(GetWorld()); it; ++it)
+  {
+    auto component = Cast<UPrimitiveComponent>(it->GetRootComponent());
+    if (component && component->IsSimulatingPhysics())
+    {
+      StressBodies.Add(component);
+    }
+  }
+
+  if (StressBodies.Num() == 0)
+  {
+    UE_LOG(LogCMCTest, Warning, TEXT("Impulse stress test needs at least one simulating body in the world."));
+    return;
+  }
+
+  StressHitsPerSecond = hitsPerSecond;
+  StressTimeRemaining = seconds;
+  StressPendingHits = 0;
+  StressHits = 0;
+  StressBodiesPushed = 0;
+  StressFrames = 0;
+  StressApplySeconds = 0;
+}
+
+void UImpulseBatchSubsystem::AddStressHits(float deltaSeconds)
+{
+  StressPendingHits += StressHitsPerSecond * deltaSeconds;
+
+  for (; StressPendingHits >= 1.f; StressPendingHits -= 1.f)
+  {
+    auto component = StressBodies[StressHits++ % StressBodies.Num()].Get();
+    if (!component)
+    {
+      continue;
+    }
+
+    // Roughly what a projectile at 3000uu/s pushes with, scaled down so bodies stay in the level.
+    auto bounds = component->Bounds;
+    auto location = bounds.Origin + FMath::VRand() * bounds.SphereRadius * 0.5f;
+    AddImpulseAtLocation(component, FMath::VRand() * 3000.f, location);
+  }
+}
+
+void UImpulseBatchSubsystem::FinishStressTest()
+{
+  UE_LOG(
+      LogCMCTest,
+      Display,
+      TEXT("Impulse stress: %d hits on %d bodies over %d frames, %d body impulses applied, %.3f ms/frame applying"),
+      StressHits,
+      StressBodies.Num(),
+      StressFrames,
+      StressBodiesPushed,
+      StressApplySeconds * 1000.0 / FMath::Max(StressFrames, 1));
+
+  StressBodies.Reset();
+  StressTimeRemaining = 0;
+}
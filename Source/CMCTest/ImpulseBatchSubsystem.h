@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ImpulseBatchSubsystem.generated.h"
+
+class UPrimitiveComponent;
+
+// Collects impulses from projectile hits over a frame and applies them in one pass at the end of it. Impulses on the
+// same body are summed into a single linear and angular impulse about its center of mass, so a body hit many times
+// in a frame is only woken and pushed once.
+UCLASS()
+class UImpulseBatchSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float deltaSeconds) override;
+  virtual TStatId GetStatId() const override;
+
+  void AddImpulseAtLocation(UPrimitiveComponent *component, const FVector &impulse, const FVector &location);
+
+  // Generates hitsPerSecond synthetic hits on simulating bodies in the world for the given time, then logs how many
+  // bodies they were coalesced into and how long applying them took.
+  void StartStressTest(float hitsPerSecond, float seconds);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+
+  void ApplyImpulses();
+  void AddStressHits(float deltaSeconds);
+  void FinishStressTest();
+
+  TMap<UPrimitiveComponent *, int32> Slots;
+  TArray<TWeakObjectPtr<UPrimitiveComponent>> Components;
+  TArray<FVector> LinearImpulses;
+  // Sum of location x impulse; the center of mass is only subtracted when the impulses are applied.
+  TArray<FVector> Moments;
+
+  TArray<TWeakObjectPtr<UPrimitiveComponent>> StressBodies;
+  float StressHitsPerSecond = 0;
+  float StressTimeRemaining = 0;
+  float StressPendingHits = 0;
+  int32 StressHits = 0;
+  int32 StressBodiesPushed = 0;
+  int32 StressFrames = 0;
+  double StressApplySeconds = 0;
+};
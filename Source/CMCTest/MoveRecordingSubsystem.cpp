@@ -0,0 +1,295 @@
+#include "MoveRecordingSubsystem.h"
+#include "CMCTest.h"
+#include "CMCTestCharacterMovementComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "OscillatorSubsystem.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static TAutoConsoleVariable<bool> CVarRecordMoves(
+    TEXT("CMCTest.Moves.Record"),
+    false,
+    TEXT("Record every move the server receives, per client. Save with CMCTest.Moves.Save."));
+
+static FAutoConsoleCommandWithWorld SaveMovesCommand(
+    TEXT("CMCTest.Moves.Save"),
+    TEXT("Writes the moves recorded so far to Saved/MoveRecordings."),
+    FConsoleCommandWithWorldDelegate::CreateLambda(
+        [](UWorld *world)
+        {
+          if (auto recording = world ? world->GetSubsystem<UMoveRecordingSubsystem>() : nullptr)
+          {
+            recording->SaveRecordings();
+          }
+        }));
+
+static FAutoConsoleCommandWithWorldAndArgs ReplayMovesCommand(
+    TEXT("CMCTest.Moves.Replay"),
+    TEXT("CMCTest.Moves.Replay <file>: replays a move recording on a server and logs a hash of the result. Run it "
+         "headless with CMCTestServer <map> -ExecCmds=\"CMCTest.Moves.Replay <file>\"."),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda(
+        [](const TArray<FString> &args, UWorld *world)
+        {
+          auto recording = world ? world->GetSubsystem<UMoveRecordingSubsystem>() : nullptr;
+          if (recording && args.Num() > 0)
+          {
+            recording->Replay(args[0]);
+          }
+        }));
+
+namespace
+{
+  constexpr uint32 RecordingMagic = 0x4D434D43; // "CMCM"
+  constexpr uint32 RecordingVersion = 2;
+
+  struct FRecordingHeader
+  {
+    uint32 Magic = RecordingMagic;
+    uint32 Version = RecordingVersion;
+    FString CharacterClass;
+    FVector Location;
+    FRotator Rotation;
+    FVector Velocity;
+    uint8 MovementMode;
+    uint8 CustomMovementMode;
+
+    friend FArchive &operator<<(FArchive &archive, FRecordingHeader &header)
+    {
+      archive << header.Magic << header.Version << header.CharacterClass << header.Location << header.Rotation
+              << header.Velocity << header.MovementMode << header.CustomMovementMode;
+      return archive;
+    }
+  };
+
+  struct FRecordedMove
+  {
+    float TimeStamp;
+    float DeltaTime;
+    // WantsToPull and StartPull travel in here just like they do over the network.
+    uint8 CompressedFlags;
+    FVector Acceleration;
+    FRotator ControlRotation;
+    double ServerTime;
+
+    // Only present on moves that start a pull. Targets are level actors, so their names match between runs.
+    FString PullTargetName;
+    FVector PullTargetOffset = FVector::ZeroVector;
+    float PullTargetTimeOffset = 0.f;
+
+    friend FArchive &operator<<(FArchive &archive, FRecordedMove &move)
+    {
+      archive << move.TimeStamp << move.DeltaTime << move.CompressedFlags << move.Acceleration << move.ControlRotation
+              << move.ServerTime;
+
+      if (move.CompressedFlags & FSavedMove_Character::FLAG_Custom_1)
+      {
+        archive << move.PullTargetName << move.PullTargetOffset << move.PullTargetTimeOffset;
+      }
+
+      return archive;
+    }
+  };
+
+  double GetServerTime(const UWorld *world)
+  {
+    auto gameState = world->GetGameState();
+    return gameState ? gameState->GetServerWorldTimeSeconds() : world->GetTimeSeconds();
+  }
+
+  AActor *FindActorByName(UWorld *world, const FString &name)
+  {
+    for (TActorIterator<AActor> it(world); it; ++it)
+    {
+      if (it->GetName() == name)
+      {
+        return *it;
+      }
+    }
+
+    return nullptr;
+  }
+}
+
+void UMoveRecordingSubsystem::Deinitialize()
+{
+  SaveRecordings();
+  Super::Deinitialize();
+}
+
+bool UMoveRecordingSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+  return worldType == EWorldType::Game || worldType == EWorldType::PIE;
+}
+
+bool UMoveRecordingSubsystem::IsRecording() const
+{
+  return !Replaying && CVarRecordMoves.GetValueOnGameThread();
+}
+
+void UMoveRecordingSubsystem::RecordMove(
+    UCMCTestCharacterMovementComponent *movement,
+    float clientTimeStamp,
+    float deltaTime,
+    uint8 compressedFlags,
+    const FVector &newAccel)
+{
+  auto character = movement->GetCharacterOwner();
+  auto &recording = Recordings.FindOrAdd(movement);
+  FMemoryWriter writer(recording, true, true);
+
+  if (recording.Num() == 0)
+  {
+    FRecordingHeader header;
+    header.CharacterClass = character->GetClass()->GetPathName();
+    header.Location = movement->UpdatedComponent->GetComponentLocation();
+    header.Rotation = movement->UpdatedComponent->GetComponentRotation();
+    header.Velocity = movement->Velocity;
+    header.MovementMode = movement->MovementMode.GetValue();
+    header.CustomMovementMode = movement->CustomMovementMode;
+    writer << header;
+  }
+
+  FRecordedMove move;
+  move.TimeStamp = clientTimeStamp;
+  move.DeltaTime = deltaTime;
+  move.CompressedFlags = compressedFlags;
+  move.Acceleration = newAccel;
+  move.ControlRotation = character->GetControlRotation();
+  move.ServerTime = GetServerTime(GetWorld());
+
+  auto moveData = static_cast<FNetworkMoveData *>(movement->GetCurrentNetworkMoveData());
+  if (moveData && (compressedFlags & FSavedMove_Character::FLAG_Custom_1))
+  {
+    move.PullTargetName = moveData->PullTargetActor ? moveData->PullTargetActor->GetName() : FString();
+    move.PullTargetOffset = moveData->PullTargetOffset;
+    move.PullTargetTimeOffset = moveData->PullTargetTimeOffset;
+  }
+
+  writer << move;
+}
+
+void UMoveRecordingSubsystem::SaveRecordings()
+{
+  auto directory = FPaths::ProjectSavedDir() / TEXT("MoveRecordings");
+  auto timeStamp = FDateTime::Now().ToString();
+
+  for (auto &recording : Recordings)
+  {
+    auto movement = recording.Key.Get();
+    auto name = movement ? movement->GetOwner()->GetName() : FString(TEXT("Disconnected"));
+    auto path = directory / FString::Printf(TEXT("%s_%s.cmcmoves"), *timeStamp, *name);
+
+    if (FFileHelper::SaveArrayToFile(recording.Value, *path))
+    {
+      UE_LOG(LogCMCTest, Display, TEXT("Saved %d bytes of moves to %s"), recording.Value.Num(), *path);
+    }
+  }
+
+  Recordings.Reset();
+}
+
+void UMoveRecordingSubsystem::Replay(const FString &path)
+{
+  auto world = GetWorld();
+  if (world->GetNetMode() != NM_DedicatedServer && world->GetNetMode() != NM_ListenServer)
+  {
+    UE_LOG(LogCMCTest, Warning, TEXT("Move replays need a server world."));
+    return;
+  }
+
+  TArray<uint8> recording;
+  if (!FFileHelper::LoadFileToArray(recording, *path))
+  {
+    UE_LOG(LogCMCTest, Warning, TEXT("Couldn't read move recording %s"), *path);
+    return;
+  }
+
+  FMemoryReader reader(recording);
+  FRecordingHeader header;
+  reader << header;
+
+  auto characterClass = FSoftClassPath(header.CharacterClass).TryLoadClass<ACharacter>();
+  if (reader.IsError() || header.Magic != RecordingMagic || header.Version != RecordingVersion || !characterClass)
+  {
+    UE_LOG(LogCMCTest, Warning, TEXT("%s is not a move recording this build can replay."), *path);
+    return;
+  }
+
+  FActorSpawnParameters spawnParameters;
+  spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+  auto character = world->SpawnActor<ACharacter>(characterClass, header.Location, header.Rotation, spawnParameters);
+  auto controller = world->SpawnActor<APlayerController>(spawnParameters);
+  auto movement = character ? Cast<UCMCTestCharacterMovementComponent>(character->GetCharacterMovement()) : nullptr;
+
+  if (!movement || !controller)
+  {
+    UE_LOG(LogCMCTest, Warning, TEXT("Couldn't spawn a character to replay %s on."), *path);
+    return;
+  }
+
+  controller->Possess(character);
+  movement->Velocity = header.Velocity;
+  movement->SetMovementMode(static_cast<EMovementMode>(header.MovementMode), header.CustomMovementMode);
+
+  // Everything runs within this call, so nothing else in the world moves unless a recorded move moves it.
+  TGuardValue<bool> replaying(Replaying, true);
+  auto oscillators = world->GetSubsystem<UOscillatorSubsystem>();
+  auto hash = 0u;
+  auto moves = 0;
+  auto startTime = FPlatformTime::Seconds();
+
+  FNetworkMoveData moveData;
+  FRecordedMove move;
+
+  while (!reader.AtEnd())
+  {
+    reader << move;
+    if (reader.IsError())
+    {
+      break;
+    }
+
+    if (oscillators)
+    {
+      oscillators->MoveToTime(move.ServerTime);
+    }
+
+    controller->SetControlRotation(move.ControlRotation);
+
+    moveData.TimeStamp = move.TimeStamp;
+    moveData.Acceleration = move.Acceleration;
+    moveData.CompressedMoveFlags = move.CompressedFlags;
+    moveData.PullTargetActor = move.PullTargetName.IsEmpty() ? nullptr : FindActorByName(world, move.PullTargetName);
+    moveData.PullTargetOffset = move.PullTargetOffset;
+    moveData.PullTargetTimeOffset = move.PullTargetTimeOffset;
+    movement->ReplayMove(moveData, move.DeltaTime, move.ServerTime);
+
+    auto location = movement->UpdatedComponent->GetComponentLocation();
+    uint8 mode[] = {static_cast<uint8>(movement->MovementMode.GetValue()), movement->CustomMovementMode};
+    hash = FCrc::MemCrc32(&location, sizeof(location), hash);
+    hash = FCrc::MemCrc32(&movement->Velocity, sizeof(movement->Velocity), hash);
+    hash = FCrc::MemCrc32(mode, sizeof(mode), hash);
+    moves++;
+  }
+
+  UE_LOG(
+      LogCMCTest,
+      Display,
+      TEXT("Replayed %d moves from %s in %.2f ms: hash %08x, final location %s"),
+      moves,
+      *path,
+      (FPlatformTime::Seconds() - startTime) * 1000.0,
+      hash,
+      *movement->UpdatedComponent->GetComponentLocation().ToString());
+
+  controller->UnPossess();
+  controller->Destroy();
+  character->Destroy();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MoveRecordingSubsystem.generated.h"
+
+class UCMCTestCharacterMovementComponent;
+
+// Records the moves the server receives from each client while CMCTest.Moves.Record is on, and replays recordings
+// without a network. Each recording starts with the character's state before its first move, and every move stores
+// the server time it ran at so oscillators can be put back where they were. Replays are therefore deterministic, and
+// the hash they log should match from run to run.
+UCLASS()
+class UMoveRecordingSubsystem : public UWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Deinitialize() override;
+
+  bool IsRecording() const;
+  void RecordMove(
+      UCMCTestCharacterMovementComponent *movement,
+      float clientTimeStamp,
+      float deltaTime,
+      uint8 compressedFlags,
+      const FVector &newAccel);
+
+  // Writes every recording to Saved/MoveRecordings and starts new ones.
+  void SaveRecordings();
+
+  // Replays a recording on a new character. Needs a server world, since a standalone world treats every controller
+  // as local and would ignore the recorded input.
+  void Replay(const FString &path);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+
+  TMap<TWeakObjectPtr<UCMCTestCharacterMovementComponent>, TArray<uint8>> Recordings;
+  bool Replaying = false;
+};
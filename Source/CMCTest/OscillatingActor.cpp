@@ -1,42 +1,113 @@
 #include "OscillatingActor.h"
-#include "Kismet/GameplayStatics.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Net/UnrealNetwork.h"
+#include "OscillatorSubsystem.h"
+#include "PullTargetSubsystem.h"
 
 AOscillatingActor::AOscillatingActor()
 {
   bReplicates = true;
   SetReplicateMovement(true);
-  PrimaryActorTick.bCanEverTick = true;
+  PrimaryActorTick.bCanEverTick = false;
 }
 
 void AOscillatingActor::BeginPlay()
 {
   Super::BeginPlay();
 
-  if (!HasAuthority())
+  // Actors spawned at runtime may already have moved by the time they reach a client, so those clients use the
+  // replicated origin instead of their spawn location.
+  if (HasAuthority() || IsNetStartupActor())
   {
-    PrimaryActorTick.SetTickFunctionEnable(false);
-    return;
+    State.Origin = GetActorLocation();
+    State.SimulateOnClients = SimulateOnClients;
+    MARK_PROPERTY_DIRTY_FROM_NAME(AOscillatingActor, State, this);
   }
 
-  PrimaryActorTick.bCanEverTick = true;
-  OriginalLocation = GetActorLocation();
+  if (HasAuthority() && State.SimulateOnClients)
+  {
+    SetReplicateMovement(false);
+    SetNetDormancy(DORM_DormantAll);
+  }
+
+  auto oscillators = GetWorld()->GetSubsystem<UOscillatorSubsystem>();
+  if (oscillators && (HasAuthority() || State.SimulateOnClients))
+  {
+    oscillators->RegisterOscillator(this);
+  }
+
+  // Registered everywhere, since the owning client looks for pull targets too.
+  if (auto pullTargets = GetWorld()->GetSubsystem<UPullTargetSubsystem>())
+  {
+    pullTargets->RegisterTarget(this);
+  }
 }
 
-void AOscillatingActor::Tick(float deltaSeconds)
+void AOscillatingActor::EndPlay(const EEndPlayReason::Type endPlayReason)
 {
-  Super::Tick(deltaSeconds);
+  if (auto oscillators = GetWorld()->GetSubsystem<UOscillatorSubsystem>())
+  {
+    oscillators->UnregisterOscillator(this);
+  }
 
-  auto time = UGameplayStatics::GetRealTimeSeconds(GetWorld());
+  if (auto pullTargets = GetWorld()->GetSubsystem<UPullTargetSubsystem>())
+  {
+    pullTargets->UnregisterTarget(this);
+  }
 
-  auto offsetX = GetOffsetValue(CurveX, time, Velocity.X, OffsetMovement.X);
-  auto offsetY = GetOffsetValue(CurveY, time, Velocity.Y, OffsetMovement.Y);
-  auto offsetZ = GetOffsetValue(CurveZ, time, Velocity.Z, OffsetMovement.Z);
+  Super::EndPlay(endPlayReason);
+}
+
+FVector AOscillatingActor::GetPredictedLocation(double serverTime) const
+{
+  // Oscillators only replicating their movement aren't simulated here, so all a client can do is extrapolate.
+  auto oscillators = GetWorld()->GetSubsystem<UOscillatorSubsystem>();
+  FVector location;
 
-  auto newOffset = FVector(offsetX, offsetY, offsetZ);
-  SetActorLocation(OriginalLocation + newOffset);
+  if (oscillators && oscillators->EvaluateLocation(this, serverTime, location))
+  {
+    return location;
+  }
+
+  return ExtrapolateLocation(this, serverTime);
+}
+
+void AOscillatingActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &outLifetimeProps) const
+{
+  Super::GetLifetimeReplicatedProps(outLifetimeProps);
+
+  // Only set before the actor first replicates, so it's push-based and never compared afterwards.
+  FDoRepLifetimeParams params;
+  params.Condition = COND_InitialOnly;
+  params.bIsPushBased = true;
+
+  DOREPLIFETIME_WITH_PARAMS_FAST(AOscillatingActor, State, params);
 }
 
-float AOscillatingActor::GetOffsetValue(UCurveFloat *curve, float time, float speed, float distance)
+bool FOscillatorState::NetSerialize(FArchive &archive, UPackageMap *packageMap, bool &outSuccess)
 {
-  return curve ? curve->GetFloatValue(FMath::Sin(time * speed)) * distance : 0;
-}
\ No newline at end of file
+  uint8 simulate = SimulateOnClients;
+  archive.SerializeBits(&simulate, 1);
+  SimulateOnClients = simulate != 0;
+
+  for (int32 axis = 0; axis < 3; axis++)
+  {
+    auto &component = Origin[axis];
+    uint8 fitsFloat = static_cast<double>(static_cast<float>(component)) == component;
+    archive.SerializeBits(&fitsFloat, 1);
+
+    if (fitsFloat)
+    {
+      auto value = static_cast<float>(component);
+      archive << value;
+      component = value;
+    }
+    else
+    {
+      archive << component;
+    }
+  }
+
+  outSuccess = !archive.IsError();
+  return true;
+}
@@ -2,17 +2,56 @@
 
 #include "CoreMinimal.h"
 #include "Curves/CurveFloat.h"
+#include "PullTarget.h"
 #include "OscillatingActor.generated.h"
 
+// What clients need to simulate an oscillator, sent once when it first replicates. Origin components that fit in a
+// float, which is most of them for placed actors, are sent as floats and the rest at full precision, so clients
+// evaluate from exactly the server's origin. FOscillatorStateNetSerializer does the same for Iris.
+USTRUCT()
+struct FOscillatorState
+{
+  GENERATED_BODY()
+
+  UPROPERTY()
+  FVector Origin = FVector::ZeroVector;
+
+  UPROPERTY()
+  bool SimulateOnClients = true;
+
+  bool NetSerialize(FArchive &archive, UPackageMap *packageMap, bool &outSuccess);
+
+  bool operator==(const FOscillatorState &other) const
+  {
+    return Origin == other.Origin && SimulateOnClients == other.SimulateOnClients;
+  }
+};
+
+template <> struct TStructOpsTypeTraits<FOscillatorState> : public TStructOpsTypeTraitsBase2<FOscillatorState>
+{
+  enum
+  {
+    WithNetSerializer = true,
+    WithIdenticalViaEquality = true,
+  };
+};
+
 UCLASS()
-class AOscillatingActor : public AActor
+class AOscillatingActor : public AActor, public IPullTarget
 {
   GENERATED_BODY()
 
+  // Oscillators are moved in one batch by the subsystem rather than ticking individually.
+  friend class UOscillatorSubsystem;
+  // Automation tests set up motion on oscillators they spawn.
+  friend struct FOscillatorTestAccess;
+
 public:
   AOscillatingActor();
   virtual void BeginPlay() override;
-  virtual void Tick(float deltaSeconds) override;
+  virtual void EndPlay(const EEndPlayReason::Type endPlayReason) override;
+  virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &outLifetimeProps) const override;
+  virtual FVector GetPredictedLocation(double serverTime) const override;
 
 protected:
   UPROPERTY(EditAnywhere)
@@ -27,7 +66,12 @@ protected:
   UPROPERTY(EditAnywhere)
   FVector Velocity;
 
-  FVector OriginalLocation;
+  // Clients evaluate the motion themselves from the synchronized server clock, so the actor only replicates once and
+  // then goes dormant. Turn off to fall back to replicated movement.
+  UPROPERTY(EditAnywhere)
+  bool SimulateOnClients = true;
 
-  float GetOffsetValue(UCurveFloat *curve, float time, float speed, float distance);
+  // Origin and SimulateOnClients as the server set them at BeginPlay. Everything but the editor reads these.
+  UPROPERTY(Replicated)
+  FOscillatorState State;
 };
@@ -0,0 +1,155 @@
+#include "OscillatorStateNetSerializer.h"
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+#include "OscillatingActor.h"
+
+namespace UE::Net
+{
+struct FOscillatorStateNetSerializer
+{
+  static const uint32 Version = 0;
+
+  // Doubles are kept as their bits, so the quantized state is plain data and compares exactly.
+  struct FQuantizedType
+  {
+    uint64 Origin[3];
+    uint8 SimulateOnClients;
+  };
+
+  typedef FOscillatorState SourceType;
+  typedef FQuantizedType QuantizedType;
+  typedef FOscillatorStateNetSerializerConfig ConfigType;
+
+  static const ConfigType DefaultConfig;
+
+  static void Serialize(FNetSerializationContext &context, const FNetSerializeArgs &args);
+  static void Deserialize(FNetSerializationContext &context, const FNetDeserializeArgs &args);
+  static void Quantize(FNetSerializationContext &context, const FNetQuantizeArgs &args);
+  static void Dequantize(FNetSerializationContext &context, const FNetDequantizeArgs &args);
+  static bool IsEqual(FNetSerializationContext &context, const FNetIsEqualArgs &args);
+  static bool Validate(FNetSerializationContext &context, const FNetValidateArgs &args);
+
+private:
+  class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+  {
+  public:
+    virtual ~FNetSerializerRegistryDelegates();
+
+  private:
+    virtual void OnPreFreezeNetSerializerRegistry() override;
+  };
+
+  static FOscillatorStateNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+};
+
+UE_NET_IMPLEMENT_SERIALIZER(FOscillatorStateNetSerializer);
+
+const FOscillatorStateNetSerializer::ConfigType FOscillatorStateNetSerializer::DefaultConfig;
+FOscillatorStateNetSerializer::FNetSerializerRegistryDelegates FOscillatorStateNetSerializer::NetSerializerRegistryDelegates;
+
+static const FName PropertyNetSerializerRegistry_NAME_OscillatorState("OscillatorState");
+UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_OscillatorState, FOscillatorStateNetSerializer);
+
+void FOscillatorStateNetSerializer::Serialize(FNetSerializationContext &context, const FNetSerializeArgs &args)
+{
+  auto &value = *reinterpret_cast<const QuantizedType *>(args.Source);
+  auto writer = context.GetBitStreamWriter();
+
+  writer->WriteBool(value.SimulateOnClients != 0);
+
+  for (auto bits : value.Origin)
+  {
+    auto component = FPlatformMath::AsFloat(bits);
+    auto fitsFloat = static_cast<double>(static_cast<float>(component)) == component;
+    writer->WriteBool(fitsFloat);
+
+    if (fitsFloat)
+    {
+      writer->WriteBits(FPlatformMath::AsUInt(static_cast<float>(component)), 32);
+    }
+    else
+    {
+      writer->WriteBits(static_cast<uint32>(bits), 32);
+      writer->WriteBits(static_cast<uint32>(bits >> 32), 32);
+    }
+  }
+}
+
+void FOscillatorStateNetSerializer::Deserialize(FNetSerializationContext &context, const FNetDeserializeArgs &args)
+{
+  auto &target = *reinterpret_cast<QuantizedType *>(args.Target);
+  auto reader = context.GetBitStreamReader();
+
+  target.SimulateOnClients = reader->ReadBool();
+
+  for (auto &bits : target.Origin)
+  {
+    if (reader->ReadBool())
+    {
+      bits = FPlatformMath::AsUInt(static_cast<double>(FPlatformMath::AsFloat(reader->ReadBits(32))));
+    }
+    else
+    {
+      uint64 low = reader->ReadBits(32);
+      uint64 high = reader->ReadBits(32);
+      bits = low | (high << 32);
+    }
+  }
+}
+
+void FOscillatorStateNetSerializer::Quantize(FNetSerializationContext &context, const FNetQuantizeArgs &args)
+{
+  auto &source = *reinterpret_cast<const SourceType *>(args.Source);
+  auto &target = *reinterpret_cast<QuantizedType *>(args.Target);
+
+  for (int32 axis = 0; axis < 3; axis++)
+  {
+    target.Origin[axis] = FPlatformMath::AsUInt(source.Origin[axis]);
+  }
+
+  target.SimulateOnClients = source.SimulateOnClients;
+}
+
+void FOscillatorStateNetSerializer::Dequantize(FNetSerializationContext &context, const FNetDequantizeArgs &args)
+{
+  auto &source = *reinterpret_cast<const QuantizedType *>(args.Source);
+  auto &target = *reinterpret_cast<SourceType *>(args.Target);
+
+  for (int32 axis = 0; axis < 3; axis++)
+  {
+    target.Origin[axis] = FPlatformMath::AsFloat(source.Origin[axis]);
+  }
+
+  target.SimulateOnClients = source.SimulateOnClients != 0;
+}
+
+bool FOscillatorStateNetSerializer::IsEqual(FNetSerializationContext &context, const FNetIsEqualArgs &args)
+{
+  if (args.bStateIsQuantized)
+  {
+    auto &value0 = *reinterpret_cast<const QuantizedType *>(args.Source0);
+    auto &value1 = *reinterpret_cast<const QuantizedType *>(args.Source1);
+    return FMemory::Memcmp(value0.Origin, value1.Origin, sizeof(value0.Origin)) == 0 &&
+           value0.SimulateOnClients == value1.SimulateOnClients;
+  }
+
+  return *reinterpret_cast<const SourceType *>(args.Source0) == *reinterpret_cast<const SourceType *>(args.Source1);
+}
+
+bool FOscillatorStateNetSerializer::Validate(FNetSerializationContext &context, const FNetValidateArgs &args)
+{
+  return !reinterpret_cast<const SourceType *>(args.Source)->Origin.ContainsNaN();
+}
+
+FOscillatorStateNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+{
+  UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_OscillatorState);
+}
+
+void FOscillatorStateNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+{
+  UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_OscillatorState);
+}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Iris/Serialization/NetSerializer.h"
+#include "OscillatorStateNetSerializer.generated.h"
+
+USTRUCT()
+struct FOscillatorStateNetSerializerConfig : public FNetSerializerConfig
+{
+  GENERATED_BODY()
+};
+
+namespace UE::Net
+{
+// Iris serializer for FOscillatorState, writing the same bits as its NetSerialize does for the legacy path so the
+// struct doesn't fall back to Iris's last resort serializer.
+UE_NET_DECLARE_SERIALIZER(FOscillatorStateNetSerializer, CMCTEST_API);
+}
@@ -0,0 +1,316 @@
+#include "OscillatorSubsystem.h"
+#include "CMCTest.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "Math/VectorRegister.h"
+#include "OscillatingActor.h"
+
+static TAutoConsoleVariable<float> CVarCurveTolerance(
+    TEXT("CMCTest.Oscillators.CurveTolerance"),
+    0.001f,
+    TEXT("Largest difference allowed between a baked oscillator curve table and the curve it was baked from."));
+
+static TAutoConsoleVariable<bool> CVarUseCurveTables(
+    TEXT("CMCTest.Oscillators.UseCurveTables"),
+    true,
+    TEXT("Evaluate oscillators from baked curve tables. Turn off to evaluate the original curves instead."));
+
+namespace
+{
+  constexpr int32 MinCurveTableResolution = 16;
+  constexpr int32 MaxCurveTableResolution = 4096;
+  // Points checked inside each table interval when baking, beyond the samples themselves.
+  constexpr int32 CurveTableChecksPerInterval = 7;
+
+  // Phases are reduced to [-pi, pi] in double precision first, so large server times don't lose precision once the
+  // sine is taken in single precision.
+  float ReducePhase(double phase)
+  {
+    return static_cast<float>(phase - UE_DOUBLE_TWO_PI * FMath::RoundToDouble(phase / UE_DOUBLE_TWO_PI));
+  }
+
+  // Same sine as the batch kernel takes four at a time, so single evaluations land exactly where the batch puts
+  // oscillators.
+  float OscillatorSine(float phase)
+  {
+    float sines[4];
+    VectorStore(VectorSin(VectorSetFloat1(phase)), sines);
+    return sines[0];
+  }
+
+  template <typename T>
+  void RemoveAxesAtSwap(TArray<T> &axes, int32 index)
+  {
+    auto last = axes.Num() - 3;
+    if (index * 3 != last)
+    {
+      for (int32 axis = 0; axis < 3; axis++)
+      {
+        axes[index * 3 + axis] = axes[last + axis];
+      }
+    }
+
+    axes.RemoveAt(last, 3);
+  }
+}
+
+void UOscillatorSubsystem::Tick(float deltaSeconds)
+{
+  Super::Tick(deltaSeconds);
+
+  auto gameState = GetWorld()->GetGameState();
+  MoveToTime(gameState ? gameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds());
+}
+
+TStatId UOscillatorSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UOscillatorSubsystem, STATGROUP_Tickables);
+}
+
+bool UOscillatorSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+  return worldType == EWorldType::Game || worldType == EWorldType::PIE;
+}
+
+void UOscillatorSubsystem::RegisterOscillator(AOscillatingActor *oscillator)
+{
+  if (!oscillator || !oscillator->GetRootComponent() || Indices.Contains(oscillator))
+  {
+    return;
+  }
+
+  if (TableStarts.Num() == 0)
+  {
+    TableStarts.Add(TableSamples.Num());
+    TableResolutions.Add(1);
+    TableSamples.Append({0.f, 0.f});
+  }
+
+  Indices.Add(oscillator, Oscillators.Add(oscillator));
+  Roots.Add(oscillator->GetRootComponent());
+  Origins.Add(oscillator->State.Origin);
+  Locations.Add(oscillator->State.Origin);
+
+  UCurveFloat *curves[] = {oscillator->CurveX, oscillator->CurveY, oscillator->CurveZ};
+
+  for (int32 axis = 0; axis < 3; axis++)
+  {
+    Curves.Add(curves[axis]);
+    Tables.Add(BakeCurveTable(curves[axis]));
+    Speeds.Add(oscillator->Velocity[axis]);
+    Distances.Add(oscillator->OffsetMovement[axis]);
+  }
+}
+
+void UOscillatorSubsystem::UnregisterOscillator(AOscillatingActor *oscillator)
+{
+  int32 index;
+  if (!Indices.RemoveAndCopyValue(oscillator, index))
+  {
+    return;
+  }
+
+  Oscillators.RemoveAtSwap(index);
+  Roots.RemoveAtSwap(index);
+  Origins.RemoveAtSwap(index);
+  Locations.RemoveAtSwap(index);
+  RemoveAxesAtSwap(Curves, index);
+  RemoveAxesAtSwap(Tables, index);
+  RemoveAxesAtSwap(Speeds, index);
+  RemoveAxesAtSwap(Distances, index);
+
+  if (Oscillators.IsValidIndex(index))
+  {
+    Indices[Oscillators[index]] = index;
+  }
+}
+
+int32 UOscillatorSubsystem::BakeCurveTable(UCurveFloat *curve)
+{
+  if (!curve)
+  {
+    return 0;
+  }
+
+  if (auto table = CurveTables.Find(curve))
+  {
+    return *table;
+  }
+
+  // Double the resolution until the largest error between samples is within tolerance.
+  auto tolerance = CVarCurveTolerance.GetValueOnGameThread();
+  auto resolution = MinCurveTableResolution;
+  TArray<float> samples;
+  float maxError;
+
+  while (true)
+  {
+    samples.SetNumUninitialized(resolution + 1);
+    for (int32 i = 0; i <= resolution; i++)
+    {
+      samples[i] = curve->GetFloatValue(-1.f + 2.f * i / resolution);
+    }
+
+    // Checked at several points per interval rather than just the midpoint, since curve keys and steep sections
+    // put the largest error anywhere between samples.
+    maxError = 0.f;
+    for (int32 i = 0; i < resolution; i++)
+    {
+      for (int32 check = 1; check <= CurveTableChecksPerInterval; check++)
+      {
+        auto alpha = static_cast<float>(check) / (CurveTableChecksPerInterval + 1);
+        auto value = curve->GetFloatValue(-1.f + 2.f * (i + alpha) / resolution);
+        maxError = FMath::Max(maxError, FMath::Abs(value - FMath::Lerp(samples[i], samples[i + 1], alpha)));
+      }
+    }
+
+    if (maxError <= tolerance || resolution >= MaxCurveTableResolution)
+    {
+      break;
+    }
+
+    resolution *= 2;
+  }
+
+  UE_LOG(
+      LogCMCTest,
+      Log,
+      TEXT("Baked oscillator curve %s into %d samples, max error %g"),
+      *curve->GetName(),
+      resolution + 1,
+      maxError);
+
+  auto table = TableStarts.Add(TableSamples.Num());
+  TableResolutions.Add(resolution);
+  TableSamples.Append(samples);
+  CurveTables.Add(curve, table);
+  return table;
+}
+
+float UOscillatorSubsystem::SampleCurveTable(int32 table, float sine) const
+{
+  auto resolution = TableResolutions[table];
+  auto position = FMath::Clamp((sine + 1.f) * 0.5f * resolution, 0.f, static_cast<float>(resolution));
+  auto index = FMath::Min(static_cast<int32>(position), resolution - 1);
+  auto samples = &TableSamples[TableStarts[table] + index];
+
+  return FMath::Lerp(samples[0], samples[1], position - index);
+}
+
+void UOscillatorSubsystem::MoveToTime(double time)
+{
+  EvaluateLocations(time);
+  ApplyLocations();
+}
+
+bool UOscillatorSubsystem::EvaluateLocation(const AOscillatingActor *oscillator, double time, FVector &outLocation) const
+{
+  auto index = Indices.Find(oscillator);
+  if (!index)
+  {
+    return false;
+  }
+
+  outLocation = EvaluateLocation(*index, time);
+  return true;
+}
+
+int32 UOscillatorSubsystem::FindOscillator(const AActor *actor) const
+{
+  auto oscillator = Cast<const AOscillatingActor>(actor);
+  auto index = oscillator ? Indices.Find(oscillator) : nullptr;
+  return index ? *index : INDEX_NONE;
+}
+
+bool UOscillatorSubsystem::IsOscillatorAt(int32 index, const AActor *actor) const
+{
+  return Oscillators.IsValidIndex(index) && Oscillators[index] == actor;
+}
+
+FVector UOscillatorSubsystem::EvaluateLocation(int32 index, double time) const
+{
+  auto useTables = CVarUseCurveTables.GetValueOnAnyThread();
+  auto location = Origins[index];
+
+  for (int32 axis = 0; axis < 3; axis++)
+  {
+    auto i = index * 3 + axis;
+    auto sine = OscillatorSine(ReducePhase(time * Speeds[i]));
+
+    if (useTables)
+    {
+      location[axis] += SampleCurveTable(Tables[i], sine) * Distances[i];
+    }
+    else if (Curves[i])
+    {
+      location[axis] += Curves[i]->GetFloatValue(sine) * Distances[i];
+    }
+  }
+
+  return location;
+}
+
+void UOscillatorSubsystem::EvaluateLocations(double time)
+{
+  auto numAxes = Speeds.Num();
+
+  // Sines are taken four at a time, so the phases are padded to a multiple of four.
+  Phases.SetNumUninitialized(Align(numAxes, 4));
+  Offsets.SetNumUninitialized(numAxes);
+
+  for (int32 i = 0; i < numAxes; i++)
+  {
+    Phases[i] = ReducePhase(time * Speeds[i]);
+  }
+
+  for (int32 i = numAxes; i < Phases.Num(); i++)
+  {
+    Phases[i] = 0.f;
+  }
+
+  for (int32 i = 0; i < Phases.Num(); i += 4)
+  {
+    VectorStore(VectorSin(VectorLoad(&Phases[i])), &Phases[i]);
+  }
+
+  if (CVarUseCurveTables.GetValueOnGameThread())
+  {
+    for (int32 i = 0; i < numAxes; i++)
+    {
+      Offsets[i] = SampleCurveTable(Tables[i], Phases[i]) * Distances[i];
+    }
+  }
+  else
+  {
+    for (int32 i = 0; i < numAxes; i++)
+    {
+      Offsets[i] = Curves[i] ? Curves[i]->GetFloatValue(Phases[i]) * Distances[i] : 0.f;
+    }
+  }
+
+  for (int32 i = 0; i < Locations.Num(); i++)
+  {
+    Locations[i] = Origins[i] + FVector(Offsets[i * 3], Offsets[i * 3 + 1], Offsets[i * 3 + 2]);
+  }
+}
+
+void UOscillatorSubsystem::ApplyLocations()
+{
+  MovementScopes.SetNum(Roots.Num());
+
+  for (int32 i = 0; i < Roots.Num(); i++)
+  {
+    if (auto root = Roots[i])
+    {
+      MovementScopes[i].Emplace(root, EScopedUpdate::DeferredUpdates);
+      root->SetWorldLocation(Locations[i]);
+    }
+  }
+
+  // Scopes have to close in reverse order of opening.
+  for (int32 i = MovementScopes.Num() - 1; i >= 0; i--)
+  {
+    MovementScopes[i].Reset();
+  }
+}
+
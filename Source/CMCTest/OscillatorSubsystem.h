@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "OscillatorSubsystem.generated.h"
+
+class AOscillatingActor;
+class UCurveFloat;
+
+// Owns every oscillating actor in the world and moves them in one pass per frame, driven by the synchronized server
+// clock so servers and clients simulating oscillators locally agree on where they are. Oscillator parameters are copied
+// into flat arrays on registration so evaluation walks contiguous memory instead of chasing each actor.
+UCLASS()
+class UOscillatorSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+  // Automation tests time the evaluation and placement passes separately.
+  friend struct FOscillatorTestAccess;
+
+public:
+  virtual void Tick(float deltaSeconds) override;
+  virtual TStatId GetStatId() const override;
+
+  void RegisterOscillator(AOscillatingActor *oscillator);
+  void UnregisterOscillator(AOscillatingActor *oscillator);
+
+  // Puts every oscillator where it is at the given server time.
+  void MoveToTime(double time);
+
+  // Where a single oscillator is at the given server time, without moving it. False if it isn't simulated here.
+  bool EvaluateLocation(const AOscillatingActor *oscillator, double time, FVector &outLocation) const;
+
+  // Index-based versions of the above for callers that resolve an oscillator once and evaluate it many times. Indices
+  // only stay valid until an oscillator is unregistered. Evaluation only reads, so it's safe on worker threads as long
+  // as nothing registers or unregisters meanwhile.
+  int32 FindOscillator(const AActor *actor) const;
+  bool IsOscillatorAt(int32 index, const AActor *actor) const;
+  FVector EvaluateLocation(int32 index, double time) const;
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+
+  int32 BakeCurveTable(UCurveFloat *curve);
+  float SampleCurveTable(int32 table, float sine) const;
+
+  void EvaluateLocations(double time);
+  void ApplyLocations();
+
+  TMap<const AOscillatingActor *, int32> Indices;
+
+  UPROPERTY()
+  TArray<AOscillatingActor *> Oscillators;
+  UPROPERTY()
+  TArray<USceneComponent *> Roots;
+  TArray<FVector> Origins;
+  TArray<FVector> Locations;
+
+  // Per-axis data, three entries per oscillator in X, Y, Z order. Axes without a curve point at table 0, which is
+  // flat zero, so the kernel never branches on missing curves.
+  UPROPERTY()
+  TArray<UCurveFloat *> Curves;
+  TArray<int32> Tables;
+  TArray<float> Speeds;
+  TArray<float> Distances;
+  TArray<float> Phases;
+  TArray<float> Offsets;
+
+  // Each curve is baked once into evenly spaced samples over the [-1, 1] range the sine can feed it, with enough
+  // samples to stay within CMCTest.Oscillators.CurveTolerance of the original curve between samples.
+  TMap<UCurveFloat *, int32> CurveTables;
+  TArray<int32> TableStarts;
+  TArray<int32> TableResolutions;
+  TArray<float> TableSamples;
+
+  // One deferred scope per root, kept alive until every oscillator has moved so overlaps are only resolved against
+  // final positions. Sized up front and never reallocated while scopes are open, since components point into it.
+  TArray<TOptional<FScopedMovementUpdate>> MovementScopes;
+};
@@ -0,0 +1,159 @@
+#include "PickUpSubsystem.h"
+#include "CMCTest.h"
+#include "CMCTestCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "TP_PickUpComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("PickUp Proximity"), STAT_PickUpProximity, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("PickUp Tests"), STAT_PickUpTests, STATGROUP_CMCTest);
+
+void UPickUpSubsystem::Tick(float deltaSeconds)
+{
+  Super::Tick(deltaSeconds);
+
+  if (PickUps.Num() == 0)
+  {
+    return;
+  }
+
+  SCOPE_CYCLE_COUNTER(STAT_PickUpProximity);
+  Touches.Reset();
+  int32 tests = 0;
+
+  for (TActorIterator<ACMCTestCharacter> it(GetWorld()); it; ++it)
+  {
+    auto character = *it;
+    auto capsule = character->GetCapsuleComponent();
+    auto location = capsule->GetComponentLocation();
+    auto capsuleRadius = capsule->GetScaledCapsuleRadius();
+    double segmentHalfHeight = capsule->GetScaledCapsuleHalfHeight_WithoutHemisphere();
+
+    auto reach = FVector(capsuleRadius + MaxRadius, capsuleRadius + MaxRadius, capsuleRadius + segmentHalfHeight + MaxRadius);
+    auto minCell = GetCell(location - reach);
+    auto maxCell = GetCell(location + reach);
+
+    for (int32 x = minCell.X; x <= maxCell.X; x++)
+    {
+      for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+      {
+        for (int32 z = minCell.Z; z <= maxCell.Z; z++)
+        {
+          auto cell = Cells.Find(FIntVector(x, y, z));
+          if (!cell)
+          {
+            continue;
+          }
+
+          for (auto index : *cell)
+          {
+            // Sphere against capsule: distance to the capsule's segment against the sum of the radii.
+            auto toPickUp = Locations[index] - location;
+            auto closest = location + FVector(0, 0, FMath::Clamp(toPickUp.Z, -segmentHalfHeight, segmentHalfHeight));
+            tests++;
+
+            if (FVector::DistSquared(Locations[index], closest) <= FMath::Square(Radii[index] + capsuleRadius))
+            {
+              Touches.Emplace(PickUps[index], character);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  INC_DWORD_STAT_BY(STAT_PickUpTests, tests);
+
+  // Broadcast after the loop, since picking something up can attach, destroy or unregister pickups.
+  for (auto &touch : Touches)
+  {
+    if (touch.Key && PickUpIndices.Contains(touch.Key))
+    {
+      UnregisterPickUp(touch.Key);
+      touch.Key->PickUp(touch.Value);
+    }
+  }
+}
+
+TStatId UPickUpSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UPickUpSubsystem, STATGROUP_Tickables);
+}
+
+bool UPickUpSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+  return worldType == EWorldType::Game || worldType == EWorldType::PIE;
+}
+
+void UPickUpSubsystem::RegisterPickUp(UTP_PickUpComponent *pickUp)
+{
+  if (!pickUp || PickUpIndices.Contains(pickUp))
+  {
+    return;
+  }
+
+  auto index = PickUps.Add(pickUp);
+  auto cell = GetCell(pickUp->GetComponentLocation());
+
+  PickUpIndices.Add(pickUp, index);
+  Locations.Add(pickUp->GetComponentLocation());
+  Radii.Add(pickUp->GetScaledSphereRadius());
+  PickUpCells.Add(cell);
+  Cells.FindOrAdd(cell).Add(index);
+  MaxRadius = FMath::Max(MaxRadius, Radii.Last());
+}
+
+void UPickUpSubsystem::UnregisterPickUp(UTP_PickUpComponent *pickUp)
+{
+  int32 index;
+  if (!PickUpIndices.RemoveAndCopyValue(pickUp, index))
+  {
+    return;
+  }
+
+  RemoveFromCell(index);
+
+  // Move the last pickup into the freed slot, and point its cell at the new index.
+  auto last = PickUps.Num() - 1;
+  if (index != last)
+  {
+    RemoveFromCell(last);
+
+    PickUps[index] = PickUps[last];
+    Locations[index] = Locations[last];
+    Radii[index] = Radii[last];
+    PickUpCells[index] = PickUpCells[last];
+
+    PickUpIndices[PickUps[index]] = index;
+    Cells.FindOrAdd(PickUpCells[index]).Add(index);
+  }
+
+  PickUps.RemoveAt(last);
+  Locations.RemoveAt(last);
+  Radii.RemoveAt(last);
+  PickUpCells.RemoveAt(last);
+}
+
+FIntVector UPickUpSubsystem::GetCell(const FVector &location) const
+{
+  return FIntVector(
+      FMath::FloorToInt32(location.X / CellSize),
+      FMath::FloorToInt32(location.Y / CellSize),
+      FMath::FloorToInt32(location.Z / CellSize));
+}
+
+void UPickUpSubsystem::RemoveFromCell(int32 index)
+{
+  auto cell = Cells.Find(PickUpCells[index]);
+  if (!cell)
+  {
+    return;
+  }
+
+  cell->RemoveSwap(index);
+  if (cell->Num() == 0)
+  {
+    Cells.Remove(PickUpCells[index]);
+  }
+}
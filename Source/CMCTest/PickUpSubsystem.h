@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PickUpSubsystem.generated.h"
+
+class ACMCTestCharacter;
+class UTP_PickUpComponent;
+
+// Finds characters touching pickups without the physics scene. Pickups are hashed into a uniform grid when they
+// register, and once a frame every character's capsule is tested against the pickups in the cells around it. Pickups
+// are expected to stay put while waiting to be picked up; one that moves has to register again.
+UCLASS()
+class UPickUpSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  static constexpr float CellSize = 500.f;
+
+  virtual void Tick(float deltaSeconds) override;
+  virtual TStatId GetStatId() const override;
+
+  void RegisterPickUp(UTP_PickUpComponent *pickUp);
+  void UnregisterPickUp(UTP_PickUpComponent *pickUp);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+
+  FIntVector GetCell(const FVector &location) const;
+  void RemoveFromCell(int32 index);
+
+  UPROPERTY()
+  TArray<UTP_PickUpComponent *> PickUps;
+  TMap<const UTP_PickUpComponent *, int32> PickUpIndices;
+
+  // Per pickup, alongside PickUps, so the test loop only touches what it needs.
+  TArray<FVector> Locations;
+  TArray<float> Radii;
+  TArray<FIntVector> PickUpCells;
+  TMap<FIntVector, TArray<int32>> Cells;
+  // Largest pickup radius registered, how far characters look into neighbouring cells. Never shrinks.
+  float MaxRadius = 0.f;
+
+  // Reused every frame.
+  TArray<TPair<UTP_PickUpComponent *, ACMCTestCharacter *>> Touches;
+};
@@ -0,0 +1,287 @@
+#include "ProjectileBatchSubsystem.h"
+#include "CMCTest.h"
+#include "CMCTestProjectile.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SphereComponent.h"
+#include "Engine/World.h"
+#include "Math/VectorRegister.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "ImpulseBatchSubsystem.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Batched Projectiles"), STAT_BatchedProjectiles, STATGROUP_CMCTest);
+
+namespace
+{
+  // Matches UProjectileMovementComponent::BounceVelocityStopSimulatingThreshold.
+  constexpr float StopBounceSpeed = 5.f;
+}
+
+void UProjectileBatchSubsystem::Tick(float deltaSeconds)
+{
+  Super::Tick(deltaSeconds);
+
+  ResolveSweeps();
+  Integrate(deltaSeconds);
+  IssueSweeps();
+  UpdateVisuals();
+
+  SET_DWORD_STAT(STAT_BatchedProjectiles, Positions.Num());
+}
+
+TStatId UProjectileBatchSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileBatchSubsystem, STATGROUP_Tickables);
+}
+
+bool UProjectileBatchSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+  return worldType == EWorldType::Game || worldType == EWorldType::PIE;
+}
+
+void UProjectileBatchSubsystem::FireShot(
+    TSubclassOf<ACMCTestProjectile> projectileClass,
+    const FVector &location,
+    const FRotator &rotation,
+    AActor *instigator)
+{
+  auto defaults = projectileClass ? projectileClass->GetDefaultObject<ACMCTestProjectile>() : nullptr;
+  if (!defaults)
+  {
+    return;
+  }
+
+  auto movement = defaults->GetProjectileMovement();
+
+  Positions.Add(location);
+  Velocities.Add(rotation.Vector() * movement->InitialSpeed);
+  Ends.Add(location);
+  GravityScales.Add(FVector(0, 0, movement->ProjectileGravityScale));
+  Radii.Add(defaults->GetCollisionComp()->GetUnscaledSphereRadius());
+  Bounciness.Add(movement->bShouldBounce ? movement->Bounciness : -1.f);
+  LifeSpans.Add(defaults->InitialLifeSpan > 0.f ? defaults->InitialLifeSpan : 3.f);
+  Instigators.Add(instigator);
+  Sweeps.Add(FTraceHandle());
+  VisualIndices.Add(FindOrAddVisual(projectileClass));
+}
+
+void UProjectileBatchSubsystem::ResolveSweeps()
+{
+  auto impulses = GetWorld()->GetSubsystem<UImpulseBatchSubsystem>();
+  FTraceDatum datum;
+
+  for (int32 i = Positions.Num() - 1; i >= 0; i--)
+  {
+    // Sweeps that were never issued or whose results were dropped, e.g. while paused, are simply issued again.
+    if (!Sweeps[i].IsValid() || !GetWorld()->QueryTraceData(Sweeps[i], datum))
+    {
+      continue;
+    }
+
+    Sweeps[i] = FTraceHandle();
+
+    auto hit = datum.OutHits.Num() > 0 && datum.OutHits[0].bBlockingHit ? &datum.OutHits[0] : nullptr;
+    if (!hit)
+    {
+      Positions[i] = Ends[i];
+      continue;
+    }
+
+    auto component = hit->GetComponent();
+    if (component && component->IsSimulatingPhysics())
+    {
+      if (impulses)
+      {
+        impulses->AddImpulseAtLocation(component, Velocities[i] * 100.0f, hit->Location);
+      }
+
+      RemoveShot(i);
+      continue;
+    }
+
+    if (Bounciness[i] < 0.f)
+    {
+      RemoveShot(i);
+      continue;
+    }
+
+    auto normal = hit->ImpactNormal;
+    Velocities[i] -= (1.f + Bounciness[i]) * FVector::DotProduct(Velocities[i], normal) * normal;
+    Positions[i] = hit->Location + normal * UE_KINDA_SMALL_NUMBER;
+
+    if (Velocities[i].SizeSquared() < FMath::Square(StopBounceSpeed))
+    {
+      RemoveShot(i);
+    }
+  }
+}
+
+void UProjectileBatchSubsystem::Integrate(float deltaSeconds)
+{
+  // The vectors are contiguous doubles, so the integration runs over them as flat arrays four values at a time
+  // regardless of which component each value is. Only the leftover values at the end are done one by one.
+  auto numValues = Positions.Num() * 3;
+  auto positions = reinterpret_cast<const double *>(Positions.GetData());
+  auto velocities = reinterpret_cast<double *>(Velocities.GetData());
+  auto ends = reinterpret_cast<double *>(Ends.GetData());
+  auto gravityScales = reinterpret_cast<const double *>(GravityScales.GetData());
+
+  auto gravityStep = static_cast<double>(GetWorld()->GetGravityZ()) * deltaSeconds;
+  auto gravityStep4 = VectorSetFloat1(gravityStep);
+  auto deltaSeconds4 = VectorSetFloat1(static_cast<double>(deltaSeconds));
+  int32 i = 0;
+
+  for (; i + 4 <= numValues; i += 4)
+  {
+    auto velocity = VectorMultiplyAdd(VectorLoad(&gravityScales[i]), gravityStep4, VectorLoad(&velocities[i]));
+    VectorStore(velocity, &velocities[i]);
+    VectorStore(VectorMultiplyAdd(velocity, deltaSeconds4, VectorLoad(&positions[i])), &ends[i]);
+  }
+
+  for (; i < numValues; i++)
+  {
+    velocities[i] += gravityScales[i] * gravityStep;
+    ends[i] = positions[i] + velocities[i] * deltaSeconds;
+  }
+
+  auto numShots = LifeSpans.Num();
+  auto deltaSecondsFloat4 = VectorSetFloat1(deltaSeconds);
+  i = 0;
+
+  for (; i + 4 <= numShots; i += 4)
+  {
+    VectorStore(VectorSubtract(VectorLoad(&LifeSpans[i]), deltaSecondsFloat4), &LifeSpans[i]);
+  }
+
+  for (; i < numShots; i++)
+  {
+    LifeSpans[i] -= deltaSeconds;
+  }
+
+  for (int32 i = Positions.Num() - 1; i >= 0; i--)
+  {
+    if (LifeSpans[i] <= 0.f)
+    {
+      RemoveShot(i);
+    }
+  }
+}
+
+void UProjectileBatchSubsystem::IssueSweeps()
+{
+  for (int32 i = 0; i < Positions.Num(); i++)
+  {
+    FCollisionQueryParams queryParams(SCENE_QUERY_STAT(BatchedProjectile), false, Instigators[i].Get());
+
+    Sweeps[i] = GetWorld()->AsyncSweepByProfile(
+        EAsyncTraceType::Single,
+        Positions[i],
+        Ends[i],
+        FQuat::Identity,
+        TEXT("Projectile"),
+        FCollisionShape::MakeSphere(Radii[i]),
+        queryParams);
+  }
+}
+
+void UProjectileBatchSubsystem::UpdateVisuals()
+{
+  // Each instanced mesh is resized to its shots and all of its transforms written in one batch.
+  for (int32 visual = 0; visual < Visuals.Num(); visual++)
+  {
+    auto mesh = Visuals[visual];
+    if (!mesh)
+    {
+      continue;
+    }
+
+    VisualTransforms.Reset();
+
+    for (int32 i = 0; i < Positions.Num(); i++)
+    {
+      if (VisualIndices[i] == visual)
+      {
+        VisualTransforms.Emplace(Velocities[i].ToOrientationQuat(), Positions[i], mesh->GetRelativeScale3D());
+      }
+    }
+
+    auto numInstances = mesh->GetInstanceCount();
+    if (numInstances < VisualTransforms.Num())
+    {
+      TArray<FTransform> added;
+      added.Init(FTransform::Identity, VisualTransforms.Num() - numInstances);
+      mesh->AddInstances(added, false, true);
+    }
+    else if (numInstances > VisualTransforms.Num())
+    {
+      TArray<int32> removed;
+      for (int32 instance = VisualTransforms.Num(); instance < numInstances; instance++)
+      {
+        removed.Add(instance);
+      }
+
+      mesh->RemoveInstances(removed);
+    }
+
+    if (VisualTransforms.Num() > 0)
+    {
+      mesh->BatchUpdateInstancesTransforms(0, VisualTransforms, true, true, true);
+    }
+  }
+}
+
+int32 UProjectileBatchSubsystem::FindOrAddVisual(TSubclassOf<ACMCTestProjectile> projectileClass)
+{
+  if (auto visual = VisualsByClass.Find(projectileClass))
+  {
+    return *visual;
+  }
+
+  // Draw shots the way the projectile actor would be drawn, from the mesh on its class defaults.
+  auto templateMesh = AActor::GetActorClassDefaultComponent<UStaticMeshComponent>(projectileClass);
+  if (!templateMesh || !templateMesh->GetStaticMesh() || GetWorld()->GetNetMode() == NM_DedicatedServer)
+  {
+    VisualsByClass.Add(projectileClass, INDEX_NONE);
+    return INDEX_NONE;
+  }
+
+  if (!VisualsActor)
+  {
+    FActorSpawnParameters spawnParams;
+    spawnParams.ObjectFlags |= RF_Transient;
+    VisualsActor = GetWorld()->SpawnActor<AActor>(spawnParams);
+    VisualsActor->SetRootComponent(NewObject<USceneComponent>(VisualsActor, TEXT("Root")));
+    VisualsActor->GetRootComponent()->RegisterComponent();
+  }
+
+  auto mesh = NewObject<UInstancedStaticMeshComponent>(VisualsActor);
+  mesh->SetStaticMesh(templateMesh->GetStaticMesh());
+  mesh->SetRelativeScale3D(templateMesh->GetRelativeScale3D());
+  mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+  mesh->SetCastShadow(templateMesh->CastShadow);
+
+  for (int32 material = 0; material < templateMesh->GetNumMaterials(); material++)
+  {
+    mesh->SetMaterial(material, templateMesh->GetMaterial(material));
+  }
+
+  mesh->SetupAttachment(VisualsActor->GetRootComponent());
+  mesh->RegisterComponent();
+
+  auto visual = Visuals.Add(mesh);
+  VisualsByClass.Add(projectileClass, visual);
+  return visual;
+}
+
+void UProjectileBatchSubsystem::RemoveShot(int32 index)
+{
+  Positions.RemoveAtSwap(index);
+  Velocities.RemoveAtSwap(index);
+  Ends.RemoveAtSwap(index);
+  GravityScales.RemoveAtSwap(index);
+  Radii.RemoveAtSwap(index);
+  Bounciness.RemoveAtSwap(index);
+  LifeSpans.RemoveAtSwap(index);
+  Instigators.RemoveAtSwap(index);
+  Sweeps.RemoveAtSwap(index);
+  VisualIndices.RemoveAtSwap(index);
+}
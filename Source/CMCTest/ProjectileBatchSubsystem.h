@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "ProjectileBatchSubsystem.generated.h"
+
+class ACMCTestProjectile;
+class UInstancedStaticMeshComponent;
+
+// Simulates shots as plain data instead of one projectile actor each. Every frame the shots are integrated four values
+// at a time and each swept through the async trace queue; a shot only moves once its sweep comes back clear the next
+// frame, and shots that hit a simulating body push it the same way ACMCTestProjectile::OnHit does. Wherever shots are
+// rendered, each projectile class is drawn as one instanced static mesh using the projectile's own mesh.
+UCLASS()
+class UProjectileBatchSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float deltaSeconds) override;
+  virtual TStatId GetStatId() const override;
+
+  // Fires a shot with the speed, radius, gravity, bounce and life span of the given projectile class.
+  void FireShot(
+      TSubclassOf<ACMCTestProjectile> projectileClass,
+      const FVector &location,
+      const FRotator &rotation,
+      AActor *instigator);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+
+  void ResolveSweeps();
+  void Integrate(float deltaSeconds);
+  void IssueSweeps();
+  void UpdateVisuals();
+  int32 FindOrAddVisual(TSubclassOf<ACMCTestProjectile> projectileClass);
+  void RemoveShot(int32 index);
+
+  TArray<FVector> Positions;
+  TArray<FVector> Velocities;
+  TArray<FVector> Ends;
+  // Gravity scale in Z, so gravity is applied to all three components at once like the rest of the integration.
+  TArray<FVector> GravityScales;
+  TArray<float> Radii;
+  // Negative for shots that stop at the first thing they hit.
+  TArray<float> Bounciness;
+  TArray<float> LifeSpans;
+  TArray<TWeakObjectPtr<AActor>> Instigators;
+  TArray<FTraceHandle> Sweeps;
+  // Index into Visuals, or INDEX_NONE for shots that aren't drawn.
+  TArray<int32> VisualIndices;
+
+  // One instanced mesh per projectile class, on an actor the subsystem owns. Never created on dedicated servers.
+  UPROPERTY()
+  TObjectPtr<AActor> VisualsActor;
+  UPROPERTY()
+  TArray<TObjectPtr<UInstancedStaticMeshComponent>> Visuals;
+  TMap<UClass *, int32> VisualsByClass;
+  TArray<FTransform> VisualTransforms;
+};
@@ -0,0 +1,103 @@
+#include "ProjectilePoolSubsystem.h"
+#include "CMCTest.h"
+#include "CMCTestProjectile.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Pool Hits"), STAT_ProjectilePoolHits, STATGROUP_CMCTest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Pool Misses"), STAT_ProjectilePoolMisses, STATGROUP_CMCTest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectiles Pooled"), STAT_ProjectilesPooled, STATGROUP_CMCTest);
+
+bool UProjectilePoolSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+  return worldType == EWorldType::Game || worldType == EWorldType::PIE;
+}
+
+void UProjectilePoolSubsystem::Prewarm(TSubclassOf<ACMCTestProjectile> projectileClass, int32 count)
+{
+  if (!projectileClass)
+  {
+    return;
+  }
+
+  auto &pool = Pools.FindOrAdd(projectileClass);
+
+  while (pool.Free.Num() < count)
+  {
+    auto projectile = SpawnProjectile(
+        projectileClass,
+        FVector::ZeroVector,
+        FRotator::ZeroRotator,
+        ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+    if (!projectile)
+    {
+      return;
+    }
+
+    projectile->Deactivate();
+    pool.Free.Add(projectile);
+    INC_DWORD_STAT(STAT_ProjectilesPooled);
+  }
+}
+
+ACMCTestProjectile *UProjectilePoolSubsystem::Acquire(
+    TSubclassOf<ACMCTestProjectile> projectileClass,
+    const FVector &location,
+    const FRotator &rotation)
+{
+  if (!projectileClass)
+  {
+    return nullptr;
+  }
+
+  auto &pool = Pools.FindOrAdd(projectileClass);
+
+  while (pool.Free.Num() > 0)
+  {
+    auto projectile = pool.Free.Pop(EAllowShrinking::No);
+    DEC_DWORD_STAT(STAT_ProjectilesPooled);
+
+    if (IsValid(projectile))
+    {
+      INC_DWORD_STAT(STAT_ProjectilePoolHits);
+      projectile->Launch(location, rotation);
+      return projectile;
+    }
+  }
+
+  INC_DWORD_STAT(STAT_ProjectilePoolMisses);
+  return SpawnProjectile(
+      projectileClass,
+      location,
+      rotation,
+      ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding);
+}
+
+void UProjectilePoolSubsystem::Release(ACMCTestProjectile *projectile)
+{
+  if (!IsValid(projectile) || !projectile->IsActive())
+  {
+    return;
+  }
+
+  projectile->Deactivate();
+  Pools.FindOrAdd(projectile->GetClass()).Free.Add(projectile);
+  INC_DWORD_STAT(STAT_ProjectilesPooled);
+}
+
+ACMCTestProjectile *UProjectilePoolSubsystem::SpawnProjectile(
+    TSubclassOf<ACMCTestProjectile> projectileClass,
+    const FVector &location,
+    const FRotator &rotation,
+    ESpawnActorCollisionHandlingMethod collisionHandling)
+{
+  FActorSpawnParameters spawnParams;
+  spawnParams.SpawnCollisionHandlingOverride = collisionHandling;
+
+  auto projectile = GetWorld()->SpawnActor<ACMCTestProjectile>(projectileClass, location, rotation, spawnParams);
+  if (projectile)
+  {
+    projectile->bPooled = true;
+  }
+
+  return projectile;
+}
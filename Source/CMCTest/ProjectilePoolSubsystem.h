@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectilePoolSubsystem.generated.h"
+
+class ACMCTestProjectile;
+
+USTRUCT()
+struct FProjectilePool
+{
+  GENERATED_BODY()
+
+  UPROPERTY()
+  TArray<ACMCTestProjectile *> Free;
+};
+
+// Keeps fired projectiles alive after they hit or expire and launches them again for later shots, so automatic fire
+// doesn't spawn, register and destroy an actor per bullet.
+UCLASS()
+class UProjectilePoolSubsystem : public UWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  // Makes sure at least count projectiles of the class are waiting in the pool.
+  void Prewarm(TSubclassOf<ACMCTestProjectile> projectileClass, int32 count);
+
+  // Launches a pooled projectile from the given transform, spawning a new one if the pool is empty.
+  ACMCTestProjectile *Acquire(
+      TSubclassOf<ACMCTestProjectile> projectileClass,
+      const FVector &location,
+      const FRotator &rotation);
+
+  void Release(ACMCTestProjectile *projectile);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+
+  ACMCTestProjectile *SpawnProjectile(
+      TSubclassOf<ACMCTestProjectile> projectileClass,
+      const FVector &location,
+      const FRotator &rotation,
+      ESpawnActorCollisionHandlingMethod collisionHandling);
+
+  UPROPERTY()
+  TMap<UClass *, FProjectilePool> Pools;
+};
@@ -0,0 +1,20 @@
+#include "PullTarget.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+
+FVector IPullTarget::GetLocationAt(const AActor *actor, double serverTime)
+{
+  if (auto pullTarget = Cast<const IPullTarget>(actor))
+  {
+    return pullTarget->GetPredictedLocation(serverTime);
+  }
+
+  return ExtrapolateLocation(actor, serverTime);
+}
+
+FVector IPullTarget::ExtrapolateLocation(const AActor *actor, double serverTime)
+{
+  auto gameState = actor->GetWorld()->GetGameState();
+  auto now = gameState ? gameState->GetServerWorldTimeSeconds() : actor->GetWorld()->GetTimeSeconds();
+  return actor->GetActorLocation() + actor->GetVelocity() * (serverTime - now);
+}
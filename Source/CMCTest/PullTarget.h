@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PullTarget.generated.h"
+
+UINTERFACE(MinimalAPI)
+class UPullTarget : public UInterface
+{
+  GENERATED_BODY()
+};
+
+// Something that can say where it will be at a given server time. Pulls aim at the target's location at the time of
+// each move, so the client predicting ahead and the server running the move later aim at the same point instead of
+// at whatever replica of the target each one happens to have.
+class IPullTarget
+{
+  GENERATED_BODY()
+
+public:
+  virtual FVector GetPredictedLocation(double serverTime) const = 0;
+
+  // Location of any actor at the given server time. Actors that don't implement the interface are extrapolated
+  // from their current velocity.
+  static FVector GetLocationAt(const AActor *actor, double serverTime);
+  static FVector ExtrapolateLocation(const AActor *actor, double serverTime);
+};
@@ -0,0 +1,473 @@
+#include "PullTargetSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "CMCTest.h"
+#include "CMCTestCharacterMovementComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "OscillatorSubsystem.h"
+#include "PullTarget.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pull Target Cone Query"), STAT_PullTargetConeQuery, STATGROUP_CMCTest);
+DECLARE_CYCLE_STAT(TEXT("Pull Frame Pass"), STAT_PullFramePass, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pull Target Snapshots"), STAT_PullTargetSnapshots, STATGROUP_CMCTest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pull Acquisitions"), STAT_PullAcquisitions, STATGROUP_CMCTest);
+
+static TAutoConsoleVariable<bool> CVarParallelPullFramePass(
+    TEXT("CMCTest.Pull.ParallelFramePass"),
+    true,
+    TEXT("Run the per-frame pull pass across worker threads. Turn off to run it serially on the game thread."));
+
+static TAutoConsoleVariable<bool> CVarVerifyPullFramePass(
+    TEXT("CMCTest.Pull.VerifyFramePass"),
+    false,
+    TEXT("Check every result of the per-frame pull pass against working it out directly, and log any that disagree."));
+
+void UPullTargetSubsystem::Initialize(FSubsystemCollectionBase &collection)
+{
+  Super::Initialize(collection);
+  TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UPullTargetSubsystem::OnWorldTickStart);
+}
+
+void UPullTargetSubsystem::Deinitialize()
+{
+  FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+  Super::Deinitialize();
+}
+
+void UPullTargetSubsystem::Tick(float deltaSeconds)
+{
+  Super::Tick(deltaSeconds);
+  UpdateGrid();
+
+  // History is only needed by the server, to check the pulls clients start.
+  if (GetWorld()->GetNetMode() == NM_Client)
+  {
+    return;
+  }
+
+  NewestSample = (NewestSample + 1) % HistorySize;
+  NumSamples = FMath::Min(NumSamples + 1, HistorySize);
+  SampleTimes[NewestSample] = GetWorld()->GetTimeSeconds();
+
+  for (int32 i = 0; i < Targets.Num(); i++)
+  {
+    if (auto actor = Targets[i])
+    {
+      Locations[i * HistorySize + NewestSample] = actor->GetActorLocation();
+    }
+  }
+}
+
+TStatId UPullTargetSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UPullTargetSubsystem, STATGROUP_Tickables);
+}
+
+bool UPullTargetSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+  return worldType == EWorldType::Game || worldType == EWorldType::PIE;
+}
+
+void UPullTargetSubsystem::RegisterTarget(AActor *actor)
+{
+  if (!actor || TargetIndices.Contains(actor))
+  {
+    return;
+  }
+
+  TargetIndices.Add(actor, Targets.Add(actor));
+
+  FVector center, extent;
+  actor->GetActorBounds(true, center, extent);
+  auto cell = GetCell(center);
+
+  CenterOffsets.Add(center - actor->GetActorLocation());
+  Radii.Add(extent.Size());
+  TargetCells.Add(cell);
+  Cells.FindOrAdd(cell).Add(actor);
+  MaxRadius = FMath::Max(MaxRadius, Radii.Last());
+
+  Locations.Reserve(Locations.Num() + HistorySize);
+
+  for (int32 i = 0; i < HistorySize; i++)
+  {
+    Locations.Add(actor->GetActorLocation());
+  }
+}
+
+void UPullTargetSubsystem::UnregisterTarget(AActor *actor)
+{
+  int32 index;
+  if (!TargetIndices.RemoveAndCopyValue(actor, index))
+  {
+    return;
+  }
+
+  if (auto cell = Cells.Find(TargetCells[index]))
+  {
+    cell->RemoveSwap(actor);
+    if (cell->Num() == 0)
+    {
+      Cells.Remove(TargetCells[index]);
+    }
+  }
+
+  auto last = Targets.Num() - 1;
+  if (index != last)
+  {
+    Targets[index] = Targets[last];
+    TargetIndices[Targets[index]] = index;
+    CenterOffsets[index] = CenterOffsets[last];
+    Radii[index] = Radii[last];
+    TargetCells[index] = TargetCells[last];
+
+    for (int32 i = 0; i < HistorySize; i++)
+    {
+      Locations[index * HistorySize + i] = Locations[last * HistorySize + i];
+    }
+  }
+
+  Targets.RemoveAt(last);
+  CenterOffsets.RemoveAt(last);
+  Radii.RemoveAt(last);
+  TargetCells.RemoveAt(last);
+  Locations.RemoveAt(last * HistorySize, HistorySize);
+}
+
+FIntVector UPullTargetSubsystem::GetCell(const FVector &location) const
+{
+  return FIntVector(
+      FMath::FloorToInt32(location.X / CellSize),
+      FMath::FloorToInt32(location.Y / CellSize),
+      FMath::FloorToInt32(location.Z / CellSize));
+}
+
+void UPullTargetSubsystem::UpdateGrid()
+{
+  // Targets only change cells when they cross a boundary, which for oscillators is rare.
+  for (int32 i = 0; i < Targets.Num(); i++)
+  {
+    auto actor = Targets[i];
+    if (!actor)
+    {
+      continue;
+    }
+
+    auto cell = GetCell(actor->GetActorLocation() + CenterOffsets[i]);
+    if (cell == TargetCells[i])
+    {
+      continue;
+    }
+
+    if (auto oldCell = Cells.Find(TargetCells[i]))
+    {
+      oldCell->RemoveSwap(actor);
+      if (oldCell->Num() == 0)
+      {
+        Cells.Remove(TargetCells[i]);
+      }
+    }
+
+    Cells.FindOrAdd(cell).Add(actor);
+    TargetCells[i] = cell;
+  }
+}
+
+AActor *UPullTargetSubsystem::FindTargetInCone(
+    const FVector &origin,
+    const FVector &direction,
+    float maxDistance,
+    float halfAngleDegrees,
+    const AActor *ignore,
+    FVector &outCenter) const
+{
+  SCOPE_CYCLE_COUNTER(STAT_PullTargetConeQuery);
+
+  // Only the cells overlapping the cone's bounding box, widened by the largest target, can hold candidates.
+  auto halfAngle = FMath::DegreesToRadians(static_cast<double>(halfAngleDegrees));
+  auto end = origin + direction * maxDistance;
+  auto coneRadius = maxDistance * FMath::Tan(halfAngle) + MaxRadius;
+
+  auto bounds = FBox(origin, origin);
+  bounds += end;
+  bounds = bounds.ExpandBy(coneRadius);
+
+  auto minCell = GetCell(bounds.Min);
+  auto maxCell = GetCell(bounds.Max);
+
+  AActor *best = nullptr;
+  auto bestScore = TNumericLimits<double>::Max();
+
+  for (int32 x = minCell.X; x <= maxCell.X; x++)
+  {
+    for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+    {
+      for (int32 z = minCell.Z; z <= maxCell.Z; z++)
+      {
+        auto cell = Cells.Find(FIntVector(x, y, z));
+        if (!cell)
+        {
+          continue;
+        }
+
+        for (auto actor : *cell)
+        {
+          if (!actor || actor == ignore)
+          {
+            continue;
+          }
+
+          auto index = TargetIndices[actor];
+          auto center = actor->GetActorLocation() + CenterOffsets[index];
+          auto toCenter = center - origin;
+          auto distance = toCenter.Size();
+
+          if (distance > maxDistance + Radii[index] || distance <= UE_KINDA_SMALL_NUMBER)
+          {
+            continue;
+          }
+
+          // Measured to the nearest edge of the target, so large and close targets are easier to hit.
+          auto angle = FMath::Acos(FMath::Clamp(FVector::DotProduct(toCenter / distance, direction), -1.0, 1.0));
+          auto edgeAngle = FMath::Max(angle - FMath::Asin(FMath::Min(Radii[index] / distance, 1.0)), 0.0);
+
+          if (edgeAngle > halfAngle)
+          {
+            continue;
+          }
+
+          // Angle matters most; distance breaks ties between targets the player is aiming at about equally.
+          auto score = edgeAngle / FMath::Max(halfAngle, UE_DOUBLE_KINDA_SMALL_NUMBER) + 0.5 * distance / maxDistance;
+          if (score < bestScore)
+          {
+            best = actor;
+            bestScore = score;
+            outCenter = center;
+          }
+        }
+      }
+    }
+  }
+
+  return best;
+}
+
+void UPullTargetSubsystem::RegisterPuller(UCMCTestCharacterMovementComponent *movement)
+{
+  Pullers.AddUnique(movement);
+}
+
+void UPullTargetSubsystem::UnregisterPuller(UCMCTestCharacterMovementComponent *movement)
+{
+  Pullers.RemoveSwap(movement);
+}
+
+void UPullTargetSubsystem::OnWorldTickStart(UWorld *world, ELevelTick tickType, float deltaSeconds)
+{
+  // Runs before the frame's client moves are received, so every move this frame sees the same results.
+  if (world == GetWorld() && world->GetNetMode() != NM_Client)
+  {
+    RunFramePass(deltaSeconds, CVarParallelPullFramePass.GetValueOnGameThread());
+  }
+}
+
+void UPullTargetSubsystem::RunFramePass(float deltaSeconds, bool parallel)
+{
+  SCOPE_CYCLE_COUNTER(STAT_PullFramePass);
+
+  auto gameState = GetWorld()->GetGameState();
+  auto time = gameState ? gameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+  auto oscillators = GetWorld()->GetSubsystem<UOscillatorSubsystem>();
+
+  // Gather: only the game thread touches the movement components and their characters. Targets other than oscillators
+  // aren't read at all, since IPullTarget and GetVelocity are virtual and may read other actors.
+  SnapshotPullers.Reset();
+  Snapshots.Reset();
+  AcquisitionPullers.Reset();
+  Acquisitions.Reset();
+
+  for (auto movement : Pullers)
+  {
+    auto character = movement ? movement->GetCharacterOwner() : nullptr;
+    if (!character || !movement->UpdatedComponent)
+    {
+      continue;
+    }
+
+    if (movement->IsPulling && movement->HitActor.IsValid())
+    {
+      auto &snapshot = Snapshots.AddDefaulted_GetRef();
+      snapshot.Target = movement->HitActor.Get();
+      snapshot.Oscillator = oscillators ? oscillators->FindOscillator(snapshot.Target) : INDEX_NONE;
+      snapshot.Time = time;
+      SnapshotPullers.Add(movement);
+
+      // Characters the server moves itself make one move this frame, from here, as long as the frame scaled by their
+      // time dilation. World time advances by the frame after this pass, so the move ends at time plus the frame.
+      if (snapshot.Oscillator != INDEX_NONE && character->IsLocallyControlled() && character->HasAuthority() &&
+          movement->IsCustomMovementMode(CMOVE_Pull))
+      {
+        auto moveDeltaTime = deltaSeconds * character->CustomTimeDilation;
+        snapshot.HasStep = true;
+        snapshot.StepStart = movement->UpdatedComponent->GetComponentLocation();
+        snapshot.StepStartSpeed = movement->PullSpeed;
+        snapshot.StepDeltaTime = movement->GetSimulationTimeStep(moveDeltaTime, 1);
+        snapshot.StepTime = (time + deltaSeconds) - (moveDeltaTime - snapshot.StepDeltaTime);
+      }
+    }
+    else if (movement->IsAcquiringPullTarget() && !character->IsLocallyControlled())
+    {
+      // Characters controlled here start pulls from their own trace, later in the frame.
+      auto &acquisition = Acquisitions.AddDefaulted_GetRef();
+      acquisition.Frame = GFrameCounter;
+      movement->GetPullTrace(acquisition.ViewStart, acquisition.ViewEnd);
+      AcquisitionPullers.Add(movement);
+    }
+  }
+
+  auto numSnapshots = Snapshots.Num();
+  if (numSnapshots + Acquisitions.Num() == 0)
+  {
+    return;
+  }
+
+  // Compute: the game thread waits here, so the components, oscillators and physics scene are only read. Snapshots
+  // come first in the index range, then acquisitions, so both share the workers.
+  ParallelFor(
+      numSnapshots + Acquisitions.Num(),
+      [this, numSnapshots](int32 i)
+      {
+        if (i < numSnapshots)
+        {
+          auto &snapshot = Snapshots[i];
+          FVector targetLocation;
+          snapshot.HasStep = snapshot.HasStep && EvaluateSnapshot(snapshot, snapshot.StepTime, targetLocation);
+
+          if (snapshot.HasStep)
+          {
+            snapshot.Step = SnapshotPullers[i]->ComputePullStep(
+                targetLocation,
+                snapshot.StepStart,
+                snapshot.StepStartSpeed,
+                snapshot.StepDeltaTime);
+          }
+        }
+        else
+        {
+          auto &acquisition = Acquisitions[i - numSnapshots];
+          acquisition.HasHit = AcquisitionPullers[i - numSnapshots]->TraceAcquisition(
+              acquisition.ViewStart,
+              acquisition.ViewEnd,
+              acquisition.Hit);
+        }
+      },
+      !parallel);
+
+  if (CVarVerifyPullFramePass.GetValueOnGameThread())
+  {
+    VerifyFramePass();
+  }
+
+  // Apply
+  for (int32 i = 0; i < numSnapshots; i++)
+  {
+    SnapshotPullers[i]->PullTargetSnapshot = Snapshots[i];
+  }
+
+  for (int32 i = 0; i < Acquisitions.Num(); i++)
+  {
+    AcquisitionPullers[i]->PullAcquisition = Acquisitions[i];
+  }
+
+  INC_DWORD_STAT_BY(STAT_PullTargetSnapshots, numSnapshots);
+  INC_DWORD_STAT_BY(STAT_PullAcquisitions, Acquisitions.Num());
+}
+
+bool UPullTargetSubsystem::EvaluateSnapshot(const FPullTargetSnapshot &snapshot, double time, FVector &outLocation) const
+{
+  auto oscillators = GetWorld()->GetSubsystem<UOscillatorSubsystem>();
+
+  if (snapshot.Oscillator == INDEX_NONE || !oscillators || !oscillators->IsOscillatorAt(snapshot.Oscillator, snapshot.Target))
+  {
+    return false;
+  }
+
+  outLocation = oscillators->EvaluateLocation(snapshot.Oscillator, time);
+  return true;
+}
+
+void UPullTargetSubsystem::VerifyFramePass() const
+{
+  // Everything the workers produced has to match what each character would have worked out for itself.
+  for (int32 i = 0; i < Snapshots.Num(); i++)
+  {
+    auto &snapshot = Snapshots[i];
+    if (!snapshot.HasStep)
+    {
+      continue;
+    }
+
+    auto direct = SnapshotPullers[i]->ComputePullStep(
+        IPullTarget::GetLocationAt(snapshot.Target, snapshot.StepTime),
+        snapshot.StepStart,
+        snapshot.StepStartSpeed,
+        snapshot.StepDeltaTime);
+
+    if (!snapshot.Step.PullPoint.Equals(direct.PullPoint, 0.01) || snapshot.Step.Speed != direct.Speed)
+    {
+      UE_LOG(
+          LogCMCTest,
+          Warning,
+          TEXT("Pull step toward %s aims at %s, but the target says %s"),
+          *snapshot.Target->GetName(),
+          *snapshot.Step.PullPoint.ToString(),
+          *direct.PullPoint.ToString());
+    }
+  }
+
+  for (int32 i = 0; i < Acquisitions.Num(); i++)
+  {
+    auto &acquisition = Acquisitions[i];
+    FHitResult hit;
+    auto hasHit = AcquisitionPullers[i]->TraceAcquisition(acquisition.ViewStart, acquisition.ViewEnd, hit);
+
+    if (hasHit != acquisition.HasHit || hit.GetActor() != acquisition.Hit.GetActor())
+    {
+      UE_LOG(
+          LogCMCTest,
+          Warning,
+          TEXT("Pull acquisition for %s hit %s, but tracing again hits %s"),
+          *GetNameSafe(AcquisitionPullers[i]->GetOwner()),
+          *GetNameSafe(acquisition.HasHit ? acquisition.Hit.GetActor() : nullptr),
+          *GetNameSafe(hasHit ? hit.GetActor() : nullptr));
+    }
+  }
+}
+
+FVector UPullTargetSubsystem::GetLocationAt(const AActor *actor, double time) const
+{
+  auto index = TargetIndices.Find(actor);
+  if (!index || NumSamples == 0 || time >= SampleTimes[NewestSample])
+  {
+    return actor->GetActorLocation();
+  }
+
+  auto history = &Locations[*index * HistorySize];
+  auto newer = NewestSample;
+
+  for (int32 i = 1; i < NumSamples; i++)
+  {
+    auto older = (NewestSample - i + HistorySize) % HistorySize;
+
+    if (SampleTimes[older] <= time)
+    {
+      auto alpha = (time - SampleTimes[older]) / FMath::Max(SampleTimes[newer] - SampleTimes[older], UE_SMALL_NUMBER);
+      return FMath::Lerp(history[older], history[newer], alpha);
+    }
+
+    newer = older;
+  }
+
+  // Older than anything we kept, the oldest sample is the best we can do.
+  return history[newer];
+}
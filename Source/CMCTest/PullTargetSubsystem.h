@@ -0,0 +1,139 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PullTargetSubsystem.generated.h"
+
+class UCMCTestCharacterMovementComponent;
+
+// One step of a pull: the point pulled toward, the direction to it, and the speed once ramped up over the step.
+struct FPullStep
+{
+  FVector PullPoint = FVector::ZeroVector;
+  FVector Direction = FVector::ZeroVector;
+  float Speed = 0.f;
+};
+
+// A pulling character's target as of the start of a server frame. Oscillators are looked up once here so pull steps
+// can evaluate them straight from the oscillator subsystem, the same way the oscillator itself does on clients.
+//
+// For characters the server moves itself, pulling toward an oscillator, Step is also the first sub-step PhysPull will
+// take this frame, worked out from where the character starts it. PhysPull takes it when it starts that sub-step from
+// the same location and speed, at the same time and length, and clears HasStep. Remote clients' moves arrive with
+// their own timestamps and lengths, and other targets may move before the character does, so those are stepped as
+// the moves run.
+struct FPullTargetSnapshot
+{
+  const AActor *Target = nullptr;
+  int32 Oscillator = INDEX_NONE;
+  double Time = 0;
+
+  bool HasStep = false;
+  FVector StepStart = FVector::ZeroVector;
+  float StepStartSpeed = 0.f;
+  float StepDeltaTime = 0.f;
+  double StepTime = 0;
+  FPullStep Step;
+};
+
+// The acquisition trace a character wanting to pull would make from its view at the start of a server frame. The
+// server's fallback trace reuses it while the view it traces from is unchanged.
+struct FPullAcquisition
+{
+  uint64 Frame = 0;
+  FVector ViewStart = FVector::ZeroVector;
+  FVector ViewEnd = FVector::ZeroVector;
+  FHitResult Hit;
+  bool HasHit = false;
+};
+
+// Keeps a short location history of moving pull targets on the server so pulls started by a client can be checked
+// against where the target was when that client saw it, rather than where it is now.
+//
+// Pull targets are also kept in a uniform grid on every machine, so acquisition can look for them in a view cone
+// instead of tracing through the whole scene.
+//
+// At the start of each server frame, before client moves are received, also runs a gather, compute and apply pass over
+// every character pulling or about to: anything virtual or owned by another actor is read on the game thread, then
+// oscillator evaluation, pull steps and acquisition traces run across worker threads, and the results are handed back
+// to the movement components before any of them moves.
+UCLASS()
+class UPullTargetSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+  friend struct FPullTestAccess;
+
+public:
+  static constexpr int32 HistorySize = 64;
+  static constexpr float CellSize = 1000.f;
+
+  virtual void Initialize(FSubsystemCollectionBase &collection) override;
+  virtual void Deinitialize() override;
+  virtual void Tick(float deltaSeconds) override;
+  virtual TStatId GetStatId() const override;
+
+  void RegisterTarget(AActor *actor);
+  void UnregisterTarget(AActor *actor);
+
+  // Location of the actor at the given world time. Actors without history report their current location.
+  FVector GetLocationAt(const AActor *actor, double time) const;
+
+  // Best target inside the cone, ranked by how far off its axis and how far along it the target is. Targets count as
+  // inside when any part of their bounding sphere is. Returns null when there is none, otherwise sets the target's
+  // bounds center.
+  AActor *FindTargetInCone(
+      const FVector &origin,
+      const FVector &direction,
+      float maxDistance,
+      float halfAngleDegrees,
+      const AActor *ignore,
+      FVector &outCenter) const;
+
+  void RegisterPuller(UCMCTestCharacterMovementComponent *movement);
+  void UnregisterPuller(UCMCTestCharacterMovementComponent *movement);
+
+  // Location of a snapshot's oscillator at the given server time. False when the target isn't a live oscillator, in
+  // which case it has to be asked directly.
+  bool EvaluateSnapshot(const FPullTargetSnapshot &snapshot, double time, FVector &outLocation) const;
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+
+  void UpdateGrid();
+  FIntVector GetCell(const FVector &location) const;
+
+  void OnWorldTickStart(UWorld *world, ELevelTick tickType, float deltaSeconds);
+  void RunFramePass(float deltaSeconds, bool parallel);
+  void VerifyFramePass() const;
+
+  UPROPERTY()
+  TArray<AActor *> Targets;
+  TMap<const AActor *, int32> TargetIndices;
+
+  // Per target: bounds center relative to the actor, bounds radius, and the grid cell holding the center.
+  TArray<FVector> CenterOffsets;
+  TArray<float> Radii;
+  TArray<FIntVector> TargetCells;
+  TMap<FIntVector, TArray<AActor *>> Cells;
+  // Largest radius registered, how far queries look into neighbouring cells. Never shrinks.
+  float MaxRadius = 0.f;
+
+  // HistorySize ring buffer slots per target, stored target after target. All targets share the sample times.
+  TArray<FVector> Locations;
+  double SampleTimes[HistorySize];
+  int32 NewestSample = 0;
+  int32 NumSamples = 0;
+
+  UPROPERTY()
+  TArray<UCMCTestCharacterMovementComponent *> Pullers;
+
+  // Frame pass, reused every frame. Per pulling character: its snapshot. Per character about to pull: its acquisition.
+  TArray<UCMCTestCharacterMovementComponent *> SnapshotPullers;
+  TArray<FPullTargetSnapshot> Snapshots;
+  TArray<UCMCTestCharacterMovementComponent *> AcquisitionPullers;
+  TArray<FPullAcquisition> Acquisitions;
+
+  FDelegateHandle TickStartHandle;
+};
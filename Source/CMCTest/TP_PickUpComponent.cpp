@@ -1,31 +1,56 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "TP_PickUpComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "PickUpSubsystem.h"
 
 UTP_PickUpComponent::UTP_PickUpComponent()
 {
-	// Setup the Sphere Collision
+	// The sphere only sets the pickup radius; the pickup subsystem tests characters against it, not physics
 	SphereRadius = 32.f;
+	SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	SetGenerateOverlapEvents(false);
 }
 
 void UTP_PickUpComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Register our Overlap Event
-	OnComponentBeginOverlap.AddDynamic(this, &UTP_PickUpComponent::OnSphereBeginOverlap);
+	// Nothing about a pickup changes until someone picks it up, so the server stops checking it for changes
+	AActor* PickUpActor = GetOwner();
+	if (PickUpActor->HasAuthority() && PickUpActor->GetIsReplicated())
+	{
+		PickUpActor->SetNetDormancy(DORM_DormantAll);
+	}
+
+	// Pickups saved with the old overlap setup would still build a physics body
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	// Register with the pickup subsystem, which tells us once when a character touches the sphere
+	if (UPickUpSubsystem* PickUps = GetWorld()->GetSubsystem<UPickUpSubsystem>())
+	{
+		PickUps->RegisterPickUp(this);
+	}
 }
 
-void UTP_PickUpComponent::OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void UTP_PickUpComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	// Checking if it is a First Person Character overlapping
-	ACMCTestCharacter* Character = Cast<ACMCTestCharacter>(OtherActor);
-	if(Character != nullptr)
+	if (UPickUpSubsystem* PickUps = GetWorld()->GetSubsystem<UPickUpSubsystem>())
 	{
-		// Notify that the actor is being picked up
-		OnPickUp.Broadcast(Character);
+		PickUps->UnregisterPickUp(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
 
-		// Unregister from the Overlap Event so it is no longer triggered
-		OnComponentBeginOverlap.RemoveAll(this);
+void UTP_PickUpComponent::PickUp(ACMCTestCharacter* PickUpCharacter)
+{
+	// Notify that the actor is being picked up
+	OnPickUp.Broadcast(PickUpCharacter);
+
+	// Send what the pickup changed, then go back to sleep
+	if (GetOwner()->HasAuthority())
+	{
+		GetOwner()->FlushNetDormancy();
 	}
 }
@@ -23,12 +23,14 @@ public:
 	FOnPickUp OnPickUp;
 
 	UTP_PickUpComponent();
+
+	/** Called by the pickup subsystem when a character touches this */
+	void PickUp(ACMCTestCharacter* PickUpCharacter);
 protected:
 
 	/** Called when the game starts */
 	virtual void BeginPlay() override;
 
-	/** Code for when something overlaps this component */
-	UFUNCTION()
-	void OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	/** Called when the game ends or the pickup is destroyed */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "TP_WeaponComponent.h"
 #include "CMCTestCharacter.h"
 #include "CMCTestProjectile.h"
+#include "CMCTestReplicationGraph.h"
 #include "GameFramework/PlayerController.h"
 #include "Camera/PlayerCameraManager.h"
 #include "Kismet/GameplayStatics.h"
@@ -12,24 +13,63 @@
 #include "Animation/AnimInstance.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "ProjectileBatchSubsystem.h"
+#include "ProjectilePoolSubsystem.h"
+#include "AssetPreloadSubsystem.h"
+#include "CMCTest.h"
+
+namespace
+{
+	/** Most shots fired in one frame after a hitch, and accepted by the server from one batch */
+	constexpr int32 MaxShotsPerFrame = 4;
+	constexpr int32 MaxShotsPerBatch = 16;
+
+	/** Fraction of FireInterval the server still accepts between shots, to allow for time stamp jitter */
+	constexpr float FireIntervalTolerance = 0.9f;
+
+	/** How far shots may deviate from the server's view of the shooter */
+	constexpr double MaxShotTimeAhead = 0.25;
+	constexpr double MaxShotAge = 1.0;
+	constexpr float MaxShotOriginError = 200.f;
+
+	double GetServerTime(const UWorld* World)
+	{
+		const AGameStateBase* GameState = World->GetGameState();
+		return GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+	}
+}
 
 // Sets default values for this component's properties
 UTP_WeaponComponent::UTP_WeaponComponent()
 {
 	// Default offset from the character location for projectiles to spawn
 	MuzzleOffset = FVector(100.0f, 0.0f, 10.0f);
+
+	bUseBatchedProjectiles = false;
+	ProjectilePoolSize = 32;
+	FireInterval = 0.1f;
+
+	PrimaryComponentTick.bCanEverTick = true;
 }
 
 
 void UTP_WeaponComponent::Fire()
+{
+	FireScheduled(0.f);
+}
+
+void UTP_WeaponComponent::FireScheduled(float SecondsLate)
 {
 	if (Character == nullptr || Character->GetController() == nullptr)
 	{
 		return;
 	}
 
+	LoadMissingAssets();
+
 	// Try and fire a projectile
-	if (ProjectileClass != nullptr)
+	if (ProjectileClass.Get() != nullptr)
 	{
 		UWorld* const World = GetWorld();
 		if (World != nullptr)
@@ -38,34 +78,152 @@ void UTP_WeaponComponent::Fire()
 			const FRotator SpawnRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
 			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
 			const FVector SpawnLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(MuzzleOffset);
-	
-			//Set Spawn Collision Handling Override
-			FActorSpawnParameters ActorSpawnParams;
-			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-	
-			// Spawn the projectile at the muzzle
-			World->SpawnActor<ACMCTestProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+
+			SpawnShot(SpawnLocation, SpawnRotation);
+
+			// Clients simulate the shot locally and queue it for the server, which simulates it authoritatively
+			if (!Character->HasAuthority())
+			{
+				FWeaponShot& Shot = PendingShots.AddDefaulted_GetRef();
+				Shot.TimeStamp = GetServerTime(World) - SecondsLate;
+				Shot.Origin = SpawnLocation;
+				Shot.Direction = SpawnRotation.Vector();
+			}
 		}
 	}
 	
 	// Try and play the sound if specified
-	if (FireSound != nullptr)
+	if (USoundBase* LoadedFireSound = FireSound.Get())
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, FireSound, Character->GetActorLocation());
+		UGameplayStatics::PlaySoundAtLocation(this, LoadedFireSound, Character->GetActorLocation());
 	}
 	
 	// Try and play a firing animation if specified
-	if (FireAnimation != nullptr)
+	if (UAnimMontage* LoadedFireAnimation = FireAnimation.Get())
 	{
 		// Get the animation object for the arms mesh
 		UAnimInstance* AnimInstance = Character->GetMesh1P()->GetAnimInstance();
 		if (AnimInstance != nullptr)
 		{
-			AnimInstance->Montage_Play(FireAnimation, 1.f);
+			AnimInstance->Montage_Play(LoadedFireAnimation, 1.f);
 		}
 	}
 }
 
+void UTP_WeaponComponent::StartFire()
+{
+	bWantsToFire = true;
+
+	if (FireCooldown <= 0.f)
+	{
+		Fire();
+		FireCooldown = FireInterval;
+	}
+}
+
+void UTP_WeaponComponent::StopFire()
+{
+	bWantsToFire = false;
+}
+
+void UTP_WeaponComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Fire on a fixed interval while the trigger is held, however fast or slow frames are
+	FireCooldown -= DeltaTime;
+	if (bWantsToFire)
+	{
+		for (int32 Shots = 0; FireCooldown <= 0.f && Shots < MaxShotsPerFrame; Shots++)
+		{
+			// Catch-up shots after a hitch carry the time each was due, so the server sees them FireInterval apart
+			FireScheduled(-FireCooldown);
+			FireCooldown += FMath::Max(FireInterval, UE_KINDA_SMALL_NUMBER);
+		}
+	}
+	FireCooldown = FMath::Max(FireCooldown, bWantsToFire ? -FireInterval : 0.f);
+
+	// Send queued shots in one unreliable batch per net update
+	TimeSinceShotsSent += DeltaTime;
+	if (Character != nullptr && PendingShots.Num() > 0 && TimeSinceShotsSent * Character->NetUpdateFrequency >= 1.f)
+	{
+		Character->ServerFireShots(PendingShots);
+		PendingShots.Reset();
+		TimeSinceShotsSent = 0.f;
+	}
+}
+
+void UTP_WeaponComponent::HandleServerShots(const TArray<FWeaponShot>& Shots)
+{
+	LoadMissingAssets();
+
+	if (Character == nullptr || ProjectileClass.Get() == nullptr)
+	{
+		return;
+	}
+
+	const double ServerTime = GetServerTime(GetWorld());
+	const float MaxOriginDistance = MuzzleOffset.Size() + MaxShotOriginError;
+
+	for (int32 Index = 0; Index < FMath::Min(Shots.Num(), MaxShotsPerBatch); Index++)
+	{
+		const FWeaponShot& Shot = Shots[Index];
+
+		// Drop shots faster than the fire rate allows, outside the time window, or away from the shooter
+		if (Shot.TimeStamp < LastServerShotTime + FireInterval * FireIntervalTolerance ||
+			Shot.TimeStamp > ServerTime + MaxShotTimeAhead ||
+			Shot.TimeStamp < ServerTime - MaxShotAge ||
+			FVector::DistSquared(Shot.Origin, Character->GetActorLocation()) > FMath::Square(MaxOriginDistance))
+		{
+			continue;
+		}
+
+		LastServerShotTime = Shot.TimeStamp;
+		SpawnShot(Shot.Origin, Shot.Direction.Rotation());
+	}
+}
+
+void UTP_WeaponComponent::GetAssetsToPreload(TArray<FSoftObjectPath>& OutPaths) const
+{
+	OutPaths.Add(ProjectileClass.ToSoftObjectPath());
+	OutPaths.Add(FireSound.ToSoftObjectPath());
+	OutPaths.Add(FireAnimation.ToSoftObjectPath());
+}
+
+void UTP_WeaponComponent::LoadMissingAssets()
+{
+	if (!ProjectileClass.IsPending() && !FireSound.IsPending() && !FireAnimation.IsPending())
+	{
+		return;
+	}
+
+	// Players are held back until the preload finishes, so getting here means an asset was left out of it
+	UE_LOG(LogCMCTest, Warning, TEXT("%s fired before its assets were preloaded, loading them now"), *GetPathName());
+	ProjectileClass.LoadSynchronous();
+	FireSound.LoadSynchronous();
+	FireAnimation.LoadSynchronous();
+}
+
+void UTP_WeaponComponent::SpawnShot(const FVector& Origin, const FRotator& Rotation)
+{
+	UWorld* const World = GetWorld();
+	TSubclassOf<ACMCTestProjectile> LoadedProjectileClass = ProjectileClass.Get();
+
+	if (bUseBatchedProjectiles)
+	{
+		// Add a shot to the projectile batch at the muzzle
+		if (UProjectileBatchSubsystem* ProjectileBatch = World->GetSubsystem<UProjectileBatchSubsystem>())
+		{
+			ProjectileBatch->FireShot(LoadedProjectileClass, Origin, Rotation, Character);
+		}
+	}
+	else if (UProjectilePoolSubsystem* ProjectilePool = World->GetSubsystem<UProjectilePoolSubsystem>())
+	{
+		// Launch a pooled projectile from the muzzle
+		ProjectilePool->Acquire(LoadedProjectileClass, Origin, Rotation);
+	}
+}
+
 bool UTP_WeaponComponent::AttachWeapon(ACMCTestCharacter* TargetCharacter)
 {
 	Character = TargetCharacter;
@@ -83,6 +241,34 @@ bool UTP_WeaponComponent::AttachWeapon(ACMCTestCharacter* TargetCharacter)
 	// add the weapon as an instance component to the character
 	Character->AddInstanceComponent(this);
 
+	// Only the holder sees the weapon from here on
+	AActor* WeaponActor = GetOwner();
+	if (WeaponActor->HasAuthority() && WeaponActor->GetIsReplicated())
+	{
+		WeaponActor->SetOwner(Character);
+		WeaponActor->bOnlyRelevantToOwner = true;
+
+		if (UCMCTestReplicationGraph* ReplicationGraph = UCMCTestReplicationGraph::Get(GetWorld()))
+		{
+			ReplicationGraph->RerouteActor(WeaponActor);
+		}
+	}
+
+	// Weapons that weren't in the map at startup load what they need now rather than on the first shot
+	if (UAssetPreloadSubsystem* Preload = GetWorld()->GetSubsystem<UAssetPreloadSubsystem>())
+	{
+		TArray<FSoftObjectPath> Paths;
+		GetAssetsToPreload(Paths);
+		Preload->Preload(MoveTemp(Paths));
+	}
+
+	// Have projectiles ready before the first shot
+	UProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>();
+	if (!bUseBatchedProjectiles && ProjectilePool != nullptr && ProjectileClass.Get() != nullptr)
+	{
+		ProjectilePool->Prewarm(ProjectileClass.Get(), ProjectilePoolSize);
+	}
+
 	// Set up action bindings
 	if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
 	{
@@ -94,8 +280,10 @@ bool UTP_WeaponComponent::AttachWeapon(ACMCTestCharacter* TargetCharacter)
 
 		if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerController->InputComponent))
 		{
-			// Fire
-			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Triggered, this, &UTP_WeaponComponent::Fire);
+			// Fire at FireInterval while held rather than once per frame
+			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Started, this, &UTP_WeaponComponent::StartFire);
+			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Completed, this, &UTP_WeaponComponent::StopFire);
+			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Canceled, this, &UTP_WeaponComponent::StopFire);
 		}
 	}
 
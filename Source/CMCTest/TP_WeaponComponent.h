@@ -8,29 +8,58 @@
 
 class ACMCTestCharacter;
 
+/** A shot fired by a client, sent to the server in batches */
+USTRUCT()
+struct FWeaponShot
+{
+	GENERATED_BODY()
+
+	/** Synchronized server world time the client fired at */
+	UPROPERTY()
+	double TimeStamp = 0.0;
+
+	UPROPERTY()
+	FVector_NetQuantize Origin;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+};
+
 UCLASS(Blueprintable, BlueprintType, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class CMCTEST_API UTP_WeaponComponent : public USkeletalMeshComponent
 {
 	GENERATED_BODY()
 
 public:
-	/** Projectile class to spawn */
+	/** Projectile class to spawn, loaded in the background by the asset preload subsystem */
 	UPROPERTY(EditDefaultsOnly, Category=Projectile)
-	TSubclassOf<class ACMCTestProjectile> ProjectileClass;
+	TSoftClassPtr<class ACMCTestProjectile> ProjectileClass;
 
-	/** Sound to play each time we fire */
+	/** Sound to play each time we fire, loaded in the background by the asset preload subsystem */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
-	USoundBase* FireSound;
+	TSoftObjectPtr<USoundBase> FireSound;
 	
-	/** AnimMontage to play each time we fire */
+	/** AnimMontage to play each time we fire, loaded in the background by the asset preload subsystem */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
-	UAnimMontage* FireAnimation;
+	TSoftObjectPtr<UAnimMontage> FireAnimation;
+
+	/** Simulate shots as data in the world's projectile batch instead of launching projectile actors */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	bool bUseBatchedProjectiles;
+
+	/** Number of projectiles kept ready in the world's projectile pool once the weapon is picked up */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	int32 ProjectilePoolSize;
+
+	/** Seconds between shots while the trigger is held, independent of frame rate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
+	float FireInterval;
 
 	/** Gun muzzle's offset from the characters location */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
 	FVector MuzzleOffset;
 
-	/** MappingContext */
+	/** MappingContext. Input assets stay hard references: they are tiny, and bound as soon as the weapon is picked up */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
 	class UInputMappingContext* FireMappingContext;
 
@@ -49,12 +78,45 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Weapon")
 	void Fire();
 
+	/** Starts firing every FireInterval until StopFire */
+	void StartFire();
+
+	/** Stops firing once the trigger is released */
+	void StopFire();
+
+	/** Adds the soft referenced assets firing needs, for the preload subsystem */
+	void GetAssetsToPreload(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/** Validates shots sent by the owning client and simulates them on the server */
+	void HandleServerShots(const TArray<FWeaponShot>& Shots);
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
 protected:
 	/** Ends gameplay for this component. */
 	UFUNCTION()
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
+	/** Fires a shot that was due the given number of seconds ago */
+	void FireScheduled(float SecondsLate);
+
+	/** Loads any weapon assets the preload has not finished, so no shot is skipped for want of them */
+	void LoadMissingAssets();
+
+	/** Launches a projectile, or adds a batched shot, from the given muzzle transform */
+	void SpawnShot(const FVector& Origin, const FRotator& Rotation);
+
 	/** The Character holding this weapon*/
 	ACMCTestCharacter* Character;
+
+	bool bWantsToFire = false;
+	float FireCooldown = 0.f;
+
+	/** Shots fired since the last send to the server */
+	TArray<FWeaponShot> PendingShots;
+	float TimeSinceShotsSent = 0.f;
+
+	/** Time stamp of the last client shot the server accepted */
+	double LastServerShotTime = -UE_BIG_NUMBER;
 };
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Curves/CurveFloat.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "OscillatingActor.h"
+#include "OscillatorSubsystem.h"
+
+// Builds worlds full of oscillators without a map, and reaches into the subsystem so its passes can be timed alone.
+struct FOscillatorTestAccess
+{
+  static UWorld *CreateWorld()
+  {
+    auto world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("OscillatorTestWorld"));
+    GEngine->CreateNewWorldContext(EWorldType::Game).SetCurrentWorld(world);
+    world->InitializeActorsForPlay(FURL());
+    return world;
+  }
+
+  static void DestroyWorld(UWorld *world)
+  {
+    GEngine->DestroyWorldContext(world);
+    world->DestroyWorld(false);
+  }
+
+  // Shaped like OscillatingBlockCurve: an eased, lopsided swing over the [-1, 1] range the sine feeds it.
+  static UCurveFloat *CreateCurve()
+  {
+    auto curve = NewObject<UCurveFloat>(GetTransientPackage());
+    curve->FloatCurve.AddKey(-1.f, -1.f);
+    curve->FloatCurve.AddKey(-0.3f, -0.6f);
+    curve->FloatCurve.AddKey(0.4f, 0.5f);
+    curve->FloatCurve.AddKey(1.f, 1.f);
+
+    for (auto key = curve->FloatCurve.GetKeyHandleIterator(); key; ++key)
+    {
+      curve->FloatCurve.SetKeyInterpMode(*key, RCIM_Cubic);
+    }
+
+    return curve;
+  }
+
+  static AOscillatingActor *SpawnOscillator(UWorld *world, UCurveFloat *curve, const FVector &location, float speed)
+  {
+    auto actor = world->SpawnActor<AOscillatingActor>();
+    auto root = NewObject<USceneComponent>(actor, TEXT("Root"));
+    actor->SetRootComponent(root);
+    root->RegisterComponent();
+    root->SetWorldLocation(location);
+
+    actor->CurveX = curve;
+    actor->CurveY = curve;
+    actor->CurveZ = curve;
+    actor->OffsetMovement = FVector(200.f, 100.f, 50.f);
+    actor->Velocity = FVector(speed, speed * 0.7f, speed * 1.3f);
+    actor->State.Origin = location;
+
+    world->GetSubsystem<UOscillatorSubsystem>()->RegisterOscillator(actor);
+    return actor;
+  }
+
+  static void SpawnGrid(UWorld *world, UCurveFloat *curve, int32 count)
+  {
+    auto columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(count)));
+
+    for (int32 i = 0; i < count; i++)
+    {
+      SpawnOscillator(world, curve, FVector((i % columns) * 300.f, (i / columns) * 300.f, 0.f), 1.f + i % 7 * 0.25f);
+    }
+  }
+
+  static void EvaluateLocations(UOscillatorSubsystem *oscillators, double time)
+  {
+    oscillators->EvaluateLocations(time);
+  }
+
+  static void ApplyLocations(UOscillatorSubsystem *oscillators)
+  {
+    oscillators->ApplyLocations();
+  }
+
+  static const TArray<FVector> &GetLocations(const UOscillatorSubsystem *oscillators)
+  {
+    return oscillators->Locations;
+  }
+
+  static const TArray<USceneComponent *> &GetRoots(const UOscillatorSubsystem *oscillators)
+  {
+    return oscillators->Roots;
+  }
+
+  static int32 BakeCurveTable(UOscillatorSubsystem *oscillators, UCurveFloat *curve)
+  {
+    return oscillators->BakeCurveTable(curve);
+  }
+
+  static float SampleCurveTable(const UOscillatorSubsystem *oscillators, int32 table, float sine)
+  {
+    return oscillators->SampleCurveTable(table, sine);
+  }
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "OscillatorTestAccess.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FOscillatorBatchedPassTest,
+    "CMCTest.Oscillators.BatchedPass",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FOscillatorBatchedPassTest::RunTest(const FString &parameters)
+{
+  constexpr int32 passes = 20;
+  auto curve = FOscillatorTestAccess::CreateCurve();
+  constexpr int32 runs = 2;
+  const int32 counts[runs] = {1000, 10000};
+  double evaluatePer1k[runs] = {};
+
+  for (int32 run = 0; run < runs; run++)
+  {
+    auto world = FOscillatorTestAccess::CreateWorld();
+    auto oscillators = world->GetSubsystem<UOscillatorSubsystem>();
+    FOscillatorTestAccess::SpawnGrid(world, curve, counts[run]);
+
+    // One pass first so table baking and array growth aren't timed.
+    FOscillatorTestAccess::EvaluateLocations(oscillators, 0.0);
+    FOscillatorTestAccess::ApplyLocations(oscillators);
+
+    double evaluateSeconds = 0;
+    double applySeconds = 0;
+    double curveSeconds = 0;
+    double sink = 0;
+    double time = 0;
+
+    for (int32 pass = 0; pass < passes; pass++)
+    {
+      time = 1000.0 + pass / 30.0;
+
+      // What each actor used to do, a sine and a rich curve lookup per axis, for comparison with the table kernel.
+      auto start = FPlatformTime::Seconds();
+      auto seconds = static_cast<float>(time);
+      for (int32 i = 0; i < counts[run]; i++)
+      {
+        auto speed = 1.f + i % 7 * 0.25f;
+        sink += curve->GetFloatValue(FMath::Sin(seconds * speed)) * 200.f;
+        sink += curve->GetFloatValue(FMath::Sin(seconds * speed * 0.7f)) * 100.f;
+        sink += curve->GetFloatValue(FMath::Sin(seconds * speed * 1.3f)) * 50.f;
+      }
+      curveSeconds += FPlatformTime::Seconds() - start;
+
+      start = FPlatformTime::Seconds();
+      FOscillatorTestAccess::EvaluateLocations(oscillators, time);
+      auto evaluated = FPlatformTime::Seconds();
+      FOscillatorTestAccess::ApplyLocations(oscillators);
+
+      evaluateSeconds += evaluated - start;
+      applySeconds += FPlatformTime::Seconds() - evaluated;
+      sink += FOscillatorTestAccess::GetLocations(oscillators)[pass % counts[run]].X;
+    }
+
+    evaluatePer1k[run] = evaluateSeconds * 1000.0 / passes * 1000.0 / counts[run];
+    AddInfo(FString::Printf(
+        TEXT("%d oscillators: evaluate %.3f ms, place %.3f ms per pass; evaluate %.4f ms, place %.4f ms per 1k"),
+        counts[run],
+        evaluateSeconds * 1000.0 / passes,
+        applySeconds * 1000.0 / passes,
+        evaluatePer1k[run],
+        applySeconds * 1000.0 / passes * 1000.0 / counts[run]));
+
+    auto evaluations = static_cast<double>(counts[run]) * 3 * passes;
+    auto curveNanoseconds = curveSeconds * 1e9 / evaluations;
+    auto tableNanoseconds = evaluateSeconds * 1e9 / evaluations;
+    AddInfo(FString::Printf(
+        TEXT("%d oscillators: per axis evaluation curve %.1f ns, table kernel %.1f ns, %.1fx speedup (checksum %g)"),
+        counts[run],
+        curveNanoseconds,
+        tableNanoseconds,
+        curveNanoseconds / FMath::Max(tableNanoseconds, UE_DOUBLE_SMALL_NUMBER),
+        sink));
+
+    // Every oscillator has to end up exactly where the batch evaluated it.
+    auto &locations = FOscillatorTestAccess::GetLocations(oscillators);
+    auto &roots = FOscillatorTestAccess::GetRoots(oscillators);
+    int32 misplaced = 0;
+
+    for (int32 i = 0; i < roots.Num(); i++)
+    {
+      misplaced += !roots[i]->GetComponentLocation().Equals(locations[i], 0.01);
+    }
+
+    TestEqual(FString::Printf(TEXT("Misplaced oscillators out of %d"), counts[run]), misplaced, 0);
+    FOscillatorTestAccess::DestroyWorld(world);
+  }
+
+  // The batch is a flat loop over contiguous arrays, so cost per oscillator should hardly grow with the count. The
+  // margin is wide since timings on shared machines are noisy.
+  TestTrue(
+      FString::Printf(
+          TEXT("Evaluation per 1k at 10k (%.4f ms) within 4x of at 1k (%.4f ms)"), evaluatePer1k[1], evaluatePer1k[0]),
+      evaluatePer1k[1] <= evaluatePer1k[0] * 4.0);
+
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FOscillatorCurveTableTest,
+    "CMCTest.Oscillators.CurveTables",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOscillatorCurveTableTest::RunTest(const FString &parameters)
+{
+  constexpr int32 count = 10000;
+  constexpr int32 accuracySamples = 100000;
+
+  auto curve = FOscillatorTestAccess::CreateCurve();
+  auto world = FOscillatorTestAccess::CreateWorld();
+  auto oscillators = world->GetSubsystem<UOscillatorSubsystem>();
+  FOscillatorTestAccess::SpawnGrid(world, curve, count);
+
+  // Accuracy: the table against the curve it was baked from, far more densely than baking checks it.
+  auto tolerance = IConsoleManager::Get().FindConsoleVariable(TEXT("CMCTest.Oscillators.CurveTolerance"))->GetFloat();
+  auto table = FOscillatorTestAccess::BakeCurveTable(oscillators, curve);
+  auto maxError = 0.f;
+
+  for (int32 i = 0; i <= accuracySamples; i++)
+  {
+    auto sine = -1.f + 2.f * i / accuracySamples;
+    auto error = FMath::Abs(FOscillatorTestAccess::SampleCurveTable(oscillators, table, sine) - curve->GetFloatValue(sine));
+    maxError = FMath::Max(maxError, error);
+  }
+
+  AddInfo(FString::Printf(TEXT("Curve table max error %g, tolerance %g"), maxError, tolerance));
+  TestTrue(TEXT("Curve table within tolerance"), maxError <= tolerance * 1.05f);
+
+  // Single evaluations, used to predict where pull targets will be, have to agree exactly with the batch.
+  auto &roots = FOscillatorTestAccess::GetRoots(oscillators);
+  auto &locations = FOscillatorTestAccess::GetLocations(oscillators);
+  auto time = 1000.0;
+  FOscillatorTestAccess::EvaluateLocations(oscillators, time);
+  int32 mismatches = 0;
+
+  for (int32 i = 0; i < roots.Num(); i++)
+  {
+    mismatches += !oscillators->EvaluateLocation(i, time).Equals(locations[i], UE_KINDA_SMALL_NUMBER);
+  }
+
+  TestEqual(TEXT("Single evaluations that differ from the batch"), mismatches, 0);
+
+  FOscillatorTestAccess::DestroyWorld(world);
+  return true;
+}
+
+#endif
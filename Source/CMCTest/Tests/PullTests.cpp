@@ -0,0 +1,372 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CMCTestCharacter.h"
+#include "CMCTestCharacterMovementComponent.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "GameFramework/PlayerController.h"
+#include "OscillatorTestAccess.h"
+#include "PullTarget.h"
+#include "PullTargetSubsystem.h"
+
+// Runs the server's pull frame pass on demand and reaches the serial path each character would otherwise take.
+struct FPullTestAccess
+{
+  static constexpr int32 SimulatedPullers = 64;
+  static constexpr int32 SimulatedFrames = 12;
+
+  static void RunFramePass(UPullTargetSubsystem *pullTargets, float deltaSeconds, bool parallel)
+  {
+    pullTargets->RunFramePass(deltaSeconds, parallel);
+  }
+
+  static bool TracePullTarget(UCMCTestCharacterMovementComponent *movement)
+  {
+    return movement->TracePullTarget();
+  }
+
+  static FVector GetPullTargetLocation(const UCMCTestCharacterMovementComponent *movement, double time)
+  {
+    return movement->GetPullTargetLocation(time);
+  }
+
+  static void PhysPull(UCMCTestCharacterMovementComponent *movement, float deltaTime)
+  {
+    movement->PhysPull(deltaTime, 0);
+  }
+
+  // Pulling toward the target from the character's current location, as BeginPull leaves it.
+  static void StartPull(UCMCTestCharacterMovementComponent *movement, AActor *target)
+  {
+    movement->IsPulling = true;
+    movement->HitActor = target;
+    movement->OffsetOnActor = FVector::ZeroVector;
+    movement->PullSpeed = 0.f;
+    movement->SetMovementMode(MOVE_Custom, CMOVE_Pull);
+  }
+
+  static AActor *SpawnBox(UWorld *world, const FVector &location)
+  {
+    auto actor = world->SpawnActor<AActor>();
+    auto box = NewObject<UBoxComponent>(actor, TEXT("Box"));
+    box->SetBoxExtent(FVector(100.f));
+    box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+    actor->SetRootComponent(box);
+    box->RegisterComponent();
+    box->SetWorldLocation(location);
+    return actor;
+  }
+
+  static UCMCTestCharacterMovementComponent *SpawnPuller(UWorld *world, const FVector &location, const FRotator &rotation)
+  {
+    FActorSpawnParameters parameters;
+    parameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    auto character = world->SpawnActor<ACMCTestCharacter>(location, rotation, parameters);
+    auto movement = Cast<UCMCTestCharacterMovementComponent>(character->GetCharacterMovement());
+
+    // Nothing has begun play, so the puller joins the frame pass by hand.
+    world->GetSubsystem<UPullTargetSubsystem>()->RegisterPuller(movement);
+    return movement;
+  }
+
+  // Standalone, so the controller is local. Possess would also restart the pawn and bind input, which needs a local
+  // player; PossessedBy is all IsLocallyControlled reads.
+  static void ControlLocally(UCMCTestCharacterMovementComponent *movement)
+  {
+    auto controller = movement->GetWorld()->SpawnActor<APlayerController>();
+    movement->GetCharacterOwner()->PossessedBy(controller);
+  }
+
+  // Pulls characters toward oscillators over frames of varying length, some long enough to split into sub-steps,
+  // the way the world runs them: the frame pass, if any, then time advances, then every character moves. Even
+  // characters are controlled here, odd ones stand in for remote clients whose moves are stamped with the server's
+  // clock. Returns every character's location after every frame, and counts the sub-steps taken from the frame pass.
+  static TArray<FVector> SimulatePulls(bool framePass, bool parallel, int32 &outFrameSteps)
+  {
+    constexpr int32 numOscillators = 16;
+    const float frameSeconds[] = {1.f / 30.f, 1.f / 60.f, 0.08f, 1.f / 30.f, 0.12f, 1.f / 45.f};
+
+    auto world = FOscillatorTestAccess::CreateWorld();
+    auto pullTargets = world->GetSubsystem<UPullTargetSubsystem>();
+    auto curve = FOscillatorTestAccess::CreateCurve();
+    world->TimeSeconds = 50.0;
+
+    TArray<AActor *> targets;
+    for (int32 i = 0; i < numOscillators; i++)
+    {
+      auto location = FVector(i * 400.f, 1500.f, 0.f);
+      targets.Add(FOscillatorTestAccess::SpawnOscillator(world, curve, location, 1.f + i % 5 * 0.5f));
+      pullTargets->RegisterTarget(targets.Last());
+    }
+
+    TArray<UCMCTestCharacterMovementComponent *> pullers;
+    for (int32 i = 0; i < SimulatedPullers; i++)
+    {
+      auto movement = SpawnPuller(world, FVector(i * 100.f, 0.f, 0.f), FRotator(0.f, 90.f, 0.f));
+      if (i % 2 == 0)
+      {
+        ControlLocally(movement);
+      }
+
+      StartPull(movement, targets[i % numOscillators]);
+      movement->OffsetOnActor = FVector(0.f, 0.f, i % 7 * 10.f);
+      movement->PullSpeed = i * 15.f;
+      pullers.Add(movement);
+    }
+
+    TArray<FVector> trajectory;
+    outFrameSteps = 0;
+
+    for (int32 frame = 0; frame < SimulatedFrames; frame++)
+    {
+      auto deltaSeconds = frameSeconds[frame % UE_ARRAY_COUNT(frameSeconds)];
+      if (framePass)
+      {
+        pullTargets->RunFramePass(deltaSeconds, parallel);
+      }
+
+      world->TimeSeconds += deltaSeconds;
+
+      for (int32 i = 0; i < pullers.Num(); i++)
+      {
+        auto movement = pullers[i];
+        if (i % 2 == 1)
+        {
+          movement->SetCurrentMoveTimeStamp(static_cast<float>(world->TimeSeconds));
+        }
+
+        auto hadStep = movement->PullTargetSnapshot.HasStep;
+        PhysPull(movement, deltaSeconds);
+        outFrameSteps += hadStep && !movement->PullTargetSnapshot.HasStep;
+        trajectory.Add(movement->UpdatedComponent->GetComponentLocation());
+      }
+    }
+
+    FOscillatorTestAccess::DestroyWorld(world);
+    return trajectory;
+  }
+
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FPullFramePassTest,
+    "CMCTest.Pull.FramePass",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPullFramePassTest::RunTest(const FString &parameters)
+{
+  constexpr int32 numOscillators = 32;
+  constexpr int32 numBoxes = 16;
+  constexpr int32 numPullers = 128;
+  constexpr float deltaSeconds = 1.f / 30.f;
+
+  auto world = FOscillatorTestAccess::CreateWorld();
+  auto pullTargets = world->GetSubsystem<UPullTargetSubsystem>();
+  auto oscillators = world->GetSubsystem<UOscillatorSubsystem>();
+  auto curve = FOscillatorTestAccess::CreateCurve();
+  auto time = world->GetTimeSeconds();
+
+  // A row of oscillators and boxes in front of a row of characters, with and without collision, so acquisitions both
+  // hit and miss and pulls aim at both kinds of target.
+  TArray<AActor *> targets;
+
+  for (int32 i = 0; i < numOscillators; i++)
+  {
+    targets.Add(FOscillatorTestAccess::SpawnOscillator(world, curve, FVector(i * 400.f, 1500.f, 0.f), 1.f + i % 5 * 0.5f));
+  }
+
+  for (int32 i = 0; i < numBoxes; i++)
+  {
+    targets.Add(FPullTestAccess::SpawnBox(world, FVector(i * 800.f + 200.f, 1200.f, 0.f)));
+  }
+
+  FOscillatorTestAccess::EvaluateLocations(oscillators, time);
+  FOscillatorTestAccess::ApplyLocations(oscillators);
+
+  for (auto target : targets)
+  {
+    pullTargets->RegisterTarget(target);
+  }
+
+  // Even characters are pulling, odd ones have just pressed pull and are waiting on a target.
+  TArray<UCMCTestCharacterMovementComponent *> pullers;
+
+  for (int32 i = 0; i < numPullers; i++)
+  {
+    auto movement = FPullTestAccess::SpawnPuller(world, FVector(i * 100.f, 0.f, 0.f), FRotator(0.f, 80.f + i % 21, 0.f));
+
+    if (i % 2 == 0)
+    {
+      movement->IsPulling = true;
+      movement->HitActor = targets[i / 2 % targets.Num()];
+      movement->OffsetOnActor = FVector(0.f, 0.f, i % 7 * 10.f);
+      movement->PullSpeed = i * 15.f;
+    }
+    else
+    {
+      movement->WantsToPull = true;
+      movement->PullPressedTime = time;
+    }
+
+    pullers.Add(movement);
+  }
+
+  // Serial and parallel passes have to agree exactly, since they run the same code on the same inputs.
+  auto start = FPlatformTime::Seconds();
+  FPullTestAccess::RunFramePass(pullTargets, deltaSeconds, false);
+  auto serialSeconds = FPlatformTime::Seconds() - start;
+
+  TArray<FPullTargetSnapshot> serialSnapshots;
+  TArray<FPullAcquisition> serialAcquisitions;
+
+  for (auto movement : pullers)
+  {
+    serialSnapshots.Add(movement->PullTargetSnapshot);
+    serialAcquisitions.Add(movement->PullAcquisition);
+    movement->PullTargetSnapshot = FPullTargetSnapshot();
+    movement->PullAcquisition = FPullAcquisition();
+  }
+
+  start = FPlatformTime::Seconds();
+  FPullTestAccess::RunFramePass(pullTargets, deltaSeconds, true);
+  auto parallelSeconds = FPlatformTime::Seconds() - start;
+
+  AddInfo(FString::Printf(
+      TEXT("%d pullers: serial pass %.3f ms, parallel pass %.3f ms"),
+      numPullers,
+      serialSeconds * 1000.0,
+      parallelSeconds * 1000.0));
+
+  int32 passMismatches = 0;
+  int32 targetMismatches = 0;
+  int32 traceMismatches = 0;
+  int32 hits = 0;
+
+  for (int32 i = 0; i < pullers.Num(); i++)
+  {
+    auto movement = pullers[i];
+    auto &snapshot = movement->PullTargetSnapshot;
+    auto &acquisition = movement->PullAcquisition;
+
+    if (i % 2 == 0)
+    {
+      auto &serial = serialSnapshots[i];
+      passMismatches += snapshot.Target != serial.Target || snapshot.Oscillator != serial.Oscillator ||
+                        snapshot.Time != serial.Time || snapshot.HasStep != serial.HasStep;
+
+      // Over the span a pull reads its target in, the server's evaluation has to match the client's.
+      for (auto sampleTime : {time - 0.25, time, time + 0.1})
+      {
+        targetMismatches += !FPullTestAccess::GetPullTargetLocation(movement, sampleTime)
+                                 .Equals(IPullTarget::GetLocationAt(snapshot.Target, sampleTime), UE_KINDA_SMALL_NUMBER);
+      }
+    }
+    else
+    {
+      auto &serial = serialAcquisitions[i];
+      passMismatches += acquisition.HasHit != serial.HasHit || acquisition.Hit.GetActor() != serial.Hit.GetActor() ||
+                        acquisition.Hit.Location != serial.Hit.Location;
+
+      // The trace the character would make for itself, and the fallback that reuses the pass's result.
+      FVector viewStart, viewEnd;
+      movement->GetPullTrace(viewStart, viewEnd);
+      FHitResult hit;
+      auto hasHit = movement->TraceAcquisition(viewStart, viewEnd, hit) && hit.GetActor();
+      auto fallbackHit = FPullTestAccess::TracePullTarget(movement);
+
+      traceMismatches += hasHit != (acquisition.HasHit && acquisition.Hit.GetActor()) || hasHit != fallbackHit ||
+                         (hasHit && (hit.GetActor() != acquisition.Hit.GetActor() ||
+                                     movement->PullTargetActor.Get() != hit.GetActor() ||
+                                     !hit.Location.Equals(acquisition.Hit.Location, UE_KINDA_SMALL_NUMBER)));
+      hits += hasHit;
+    }
+  }
+
+  AddInfo(FString::Printf(TEXT("%d of %d acquisitions hit a target"), hits, numPullers / 2));
+  TestEqual(TEXT("Parallel results differing from serial"), passMismatches, 0);
+  TestEqual(TEXT("Target locations differing from asking the target"), targetMismatches, 0);
+  TestEqual(TEXT("Acquisitions differing from tracing directly"), traceMismatches, 0);
+
+  FOscillatorTestAccess::DestroyWorld(world);
+
+  // Pull steps: characters have to end up in exactly the same places whether the frame pass stepped them serially, in
+  // parallel, or not at all, and every move the server makes itself has to take its first sub-step from the pass.
+  int32 serialSteps, parallelSteps, unusedSteps;
+  auto serialTrajectory = FPullTestAccess::SimulatePulls(true, false, serialSteps);
+  auto parallelTrajectory = FPullTestAccess::SimulatePulls(true, true, parallelSteps);
+  auto directTrajectory = FPullTestAccess::SimulatePulls(false, false, unusedSteps);
+  int32 serialMismatches = 0;
+  int32 directMismatches = 0;
+
+  for (int32 i = 0; i < serialTrajectory.Num(); i++)
+  {
+    serialMismatches += parallelTrajectory[i] != serialTrajectory[i];
+    directMismatches += parallelTrajectory[i] != directTrajectory[i];
+  }
+
+  auto localMoves = FPullTestAccess::SimulatedPullers / 2 * FPullTestAccess::SimulatedFrames;
+  TestEqual(TEXT("Parallel pull locations differing from serial"), serialMismatches, 0);
+  TestEqual(TEXT("Pull locations differing from stepping without the frame pass"), directMismatches, 0);
+  TestEqual(TEXT("Serial moves taking their first sub-step from the frame pass"), serialSteps, localMoves);
+  TestEqual(TEXT("Parallel moves taking their first sub-step from the frame pass"), parallelSteps, localMoves);
+
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FPullLocalAuthorityTest,
+    "CMCTest.Pull.LocalAuthority",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPullLocalAuthorityTest::RunTest(const FString &parameters)
+{
+  constexpr float deltaSeconds = 1.f / 60.f;
+
+  auto world = FOscillatorTestAccess::CreateWorld();
+  auto curve = FOscillatorTestAccess::CreateCurve();
+
+  // Well into the match, so a pull aimed at server time zero would head somewhere else.
+  world->TimeSeconds = 100.0;
+  auto time = world->GetTimeSeconds();
+  auto target = FOscillatorTestAccess::SpawnOscillator(world, curve, FVector(0.f, 1500.f, 0.f), 1.3f);
+
+  auto movement = FPullTestAccess::SpawnPuller(world, FVector::ZeroVector, FRotator(0.f, 90.f, 0.f));
+  auto character = movement->GetCharacterOwner();
+
+  FPullTestAccess::ControlLocally(movement);
+
+  if (!TestTrue(
+          TEXT("Puller is locally controlled on the authority"),
+          character->IsLocallyControlled() && character->HasAuthority()))
+  {
+    FOscillatorTestAccess::DestroyWorld(world);
+    return false;
+  }
+
+  // No saved move or client move ever stamps this pawn's moves, so the pull has to aim at the frame's time.
+  auto start = movement->UpdatedComponent->GetComponentLocation();
+  auto targetNow = IPullTarget::GetLocationAt(target, time);
+  auto targetAtZero = IPullTarget::GetLocationAt(target, 0.0);
+  TestFalse(TEXT("Target moves between server time zero and now"), targetNow.Equals(targetAtZero, 1.f));
+
+  FPullTestAccess::StartPull(movement, target);
+  FPullTestAccess::PhysPull(movement, deltaSeconds);
+
+  auto expected = (targetNow - start).GetSafeNormal();
+  auto direction = movement->Velocity.GetSafeNormal();
+  TestTrue(
+      FString::Printf(
+          TEXT("Pulled toward %s (direction %s, expected %s)"),
+          *targetNow.ToString(),
+          *direction.ToString(),
+          *expected.ToString()),
+      direction.Equals(expected, 1e-3));
+
+  FOscillatorTestAccess::DestroyWorld(world);
+  return true;
+}
+
+#endif